@@ -0,0 +1,379 @@
+/*
+ *  Copyright 2025 Mendel Dobondi-Reisz
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+// C++ Standard Libraries
+#include <filesystem>
+#include <algorithm>
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <array>
+#include <cmath>
+
+// External Libraries
+#include <cspice/SpiceUsr.h>
+
+// Project Headers
+#include "bench_fixtures.hpp"
+#include <spice_core.hpp>
+#include <utils.hpp>
+
+
+
+// ─────────────────────────────────────────────
+// Fixture Bodies - circular orbits around the real centers
+// ─────────────────────────────────────────────
+
+#define UNIX_J2000 946728000.0                  // 2000-01-01T12:00:00 UTC
+#define TDB_MINUS_UTC 69.184                    // 37 leap seconds + 32.184 s, constant over the fixture span
+
+struct FixtureOrbit {
+    SpiceInt body;
+    SpiceInt center;
+    SpiceDouble radius;                         // km
+    SpiceDouble period;                         // s
+    SpiceDouble inclination;                    // deg to the J2000 equator
+    SpiceDouble phase;                          // deg at the start of the span
+};
+
+// Every default object except the SSB, chained down to it like the real kernels
+static const std::vector<FixtureOrbit> naturalOrbits = {
+    { 10, 0, 7.4e5, 3.74e8, 1.3, 0.0 },
+    { 199, 10, 5.79e7, 7.60e6, 7.0, 40.0 },
+    { 299, 10, 1.082e8, 1.94e7, 3.4, 110.0 },
+    { 3, 10, 1.496e8, 3.156e7, 23.4, 200.0 },
+    { 399, 3, 4.67e3, 2.36e6, 28.6, 180.0 },
+    { 301, 3, 3.797e5, 2.36e6, 28.6, 0.0 },
+    { 499, 10, 2.279e8, 5.94e7, 24.7, 300.0 },
+    { 401, 499, 9.376e3, 2.76e4, 37.1, 0.0 },
+    { 402, 499, 2.346e4, 1.09e5, 36.5, 90.0 },
+    { -658030, 10, 2.46e8, 6.65e7, 3.4, 250.0 },
+    { -658031, -658030, 1.19, 4.29e4, 10.0, 0.0 },
+    { -91900, -658031, 0.08, 4.29e4, 10.0, 0.0 }        // Fixed on Dimorphos, which rotates synchronously
+};
+
+static const std::vector<FixtureOrbit> spacecraftOrbits = {
+    { -91000, -658030, 20.0, 2.6e5, 60.0, 0.0 },
+    { -9101000, -658030, 5.0, 8.64e4, 80.0, 120.0 },
+    { -9102000, -658030, 10.0, 1.73e5, 45.0, 240.0 }
+};
+
+struct FixtureRotation {
+    SpiceInt body;
+    SpiceDouble poleRa, poleDec, meridian, rate;    // deg, deg, deg, deg/day
+};
+
+// IAU_<body> frames from the text PCK
+static const std::vector<FixtureRotation> iauRotations = {
+    { 10, 286.13, 63.87, 84.176, 14.1844 },
+    { 199, 281.01, 61.45, 329.548, 6.1385025 },
+    { 299, 272.76, 67.16, 160.20, -1.4813688 },
+    { 399, 0.0, 90.0, 190.147, 360.9856235 },
+    { 301, 269.9949, 66.5392, 38.3213, 13.17635815 },
+    { 499, 317.68143, 52.88650, 176.630, 350.89198226 },
+    { 401, 317.68, 52.90, 35.06, 1128.8445850 },
+    { 402, 316.65, 53.52, 79.41, 285.1618970 }
+};
+
+// Asteroid frames from the binary PCK: class id, body, pole and spin
+static const std::vector<std::pair<SpiceInt, FixtureRotation>> asteroidRotations = {
+    { 1658030, { -658030, 310.0, -84.0, 0.0, 3819.0 } },    // DIDYMOS_FIXED, 2.26 h
+    { 1658031, { -658031, 310.0, -84.0, 0.0, 724.7 } }      // DIMORPHOS_FIXED, synchronous with its orbit
+};
+
+static SpiceDouble fixtureEt(double utcTimestamp) {
+    return utcTimestamp - UNIX_J2000 + TDB_MINUS_UTC;
+}
+
+static void orbitState(const FixtureOrbit& orbit, SpiceDouble seconds, SpiceDouble state[6]) {
+    SpiceDouble rate = twopi_c() / orbit.period;
+    SpiceDouble angle = orbit.phase * rpd_c() + rate * seconds;
+    SpiceDouble inclination = orbit.inclination * rpd_c();
+
+    state[0] = orbit.radius * std::cos(angle);
+    state[1] = orbit.radius * std::sin(angle) * std::cos(inclination);
+    state[2] = orbit.radius * std::sin(angle) * std::sin(inclination);
+    state[3] = -orbit.radius * rate * std::sin(angle);
+    state[4] = orbit.radius * rate * std::cos(angle) * std::cos(inclination);
+    state[5] = orbit.radius * rate * std::cos(angle) * std::sin(inclination);
+}
+
+static bool spiceFailed(const std::string& step) {
+    if (!failed_c()) return false;
+
+    SpiceChar message[1841];
+    getmsg_c("LONG", sizeof(message), message);
+    reset_c();
+    std::cerr << color("error") << "Fixture " << step << " failed: " << message << "\n" << std::flush;
+    return true;
+}
+
+
+
+// ─────────────────────────────────────────────
+// Text Kernels - LSK, PCK, FK, SCLK and meta-kernels
+// ─────────────────────────────────────────────
+
+static bool writeTextKernel(const std::filesystem::path& path, const std::string& contents) {
+    std::ofstream file(path, std::ios::trunc);
+    file << contents;
+    if (file) return true;
+
+    std::cerr << color("error") << "Cannot write fixture kernel: " << path << "\n" << std::flush;
+    return false;
+}
+
+static std::string leapSecondKernel() {
+    return "KPL/LSK\n\n\\begindata\n\n"
+           "DELTET/DELTA_T_A = 32.184\n"
+           "DELTET/K = 1.657D-3\n"
+           "DELTET/EB = 1.671D-2\n"
+           "DELTET/M = ( 6.239996D0 1.99096871D-7 )\n"
+           "DELTET/DELTA_AT = ( 10, @1972-JAN-1  11, @1972-JUL-1  12, @1973-JAN-1  13, @1974-JAN-1\n"
+           "                    14, @1975-JAN-1  15, @1976-JAN-1  16, @1977-JAN-1  17, @1978-JAN-1\n"
+           "                    18, @1979-JAN-1  19, @1980-JAN-1  20, @1981-JUL-1  21, @1982-JUL-1\n"
+           "                    22, @1983-JUL-1  23, @1985-JUL-1  24, @1988-JAN-1  25, @1990-JAN-1\n"
+           "                    26, @1991-JAN-1  27, @1992-JUL-1  28, @1993-JUL-1  29, @1994-JUL-1\n"
+           "                    30, @1996-JAN-1  31, @1997-JUL-1  32, @1999-JAN-1  33, @2006-JAN-1\n"
+           "                    34, @2009-JAN-1  35, @2012-JUL-1  36, @2015-JUL-1  37, @2017-JAN-1 )\n\n"
+           "\\begintext\n";
+}
+
+static std::string planetaryConstantsKernel() {
+    std::string kernel = "KPL/PCK\n\n\\begindata\n\n";
+    for (const FixtureRotation& rotation : iauRotations) {
+        std::string body = "BODY" + std::to_string(rotation.body);
+        kernel += body + "_POLE_RA = ( " + std::to_string(rotation.poleRa) + " 0.0 0.0 )\n";
+        kernel += body + "_POLE_DEC = ( " + std::to_string(rotation.poleDec) + " 0.0 0.0 )\n";
+        kernel += body + "_PM = ( " + std::to_string(rotation.meridian) + " " + std::to_string(rotation.rate) + " 0.0 )\n\n";
+    }
+    return kernel + "\\begintext\n";
+}
+
+static std::string frameKernel() {
+    std::string kernel = "KPL/FK\n\n\\begindata\n\n"
+                         "NAIF_BODY_NAME += ( 'DIDYMOS', 'DIMORPHOS', 'DART_IMPACT_SITE', 'HERA', 'JUVENTAS', 'MILANI' )\n"
+                         "NAIF_BODY_CODE += ( -658030, -658031, -91900, -91000, -9101000, -9102000 )\n\n"
+                         "OBJECT_0_FRAME = 'J2000'\n"
+                         "OBJECT_-91900_FRAME = 'DIMORPHOS_FIXED'\n\n";
+
+    const std::array<std::pair<SpiceInt, const char*>, 2> asteroids = {{ { -658030, "DIDYMOS_FIXED" }, { -658031, "DIMORPHOS_FIXED" } }};
+    for (size_t i = 0; i < asteroids.size(); i++) {
+        std::string id = std::to_string(asteroidRotations[i].first);
+        std::string name = asteroids[i].second;
+        kernel += "FRAME_" + name + " = " + id + "\n";
+        kernel += "FRAME_" + id + "_NAME = '" + name + "'\n";
+        kernel += "FRAME_" + id + "_CLASS = 2\n";
+        kernel += "FRAME_" + id + "_CLASS_ID = " + id + "\n";
+        kernel += "FRAME_" + id + "_CENTER = " + std::to_string(asteroids[i].first) + "\n";
+        kernel += "OBJECT_" + std::to_string(asteroids[i].first) + "_FRAME = '" + name + "'\n\n";
+    }
+
+    const std::array<std::pair<SpiceInt, const char*>, 3> spacecraft = {{
+        { -91000, "HERA_SPACECRAFT" }, { -9101000, "JUVENTAS_SPACECRAFT" }, { -9102000, "MILANI_SPACECRAFT" }
+    }};
+    for (const auto& [body, name] : spacecraft) {
+        std::string id = std::to_string(body);
+        kernel += "FRAME_" + std::string(name) + " = " + id + "\n";
+        kernel += "FRAME_" + id + "_NAME = '" + name + "'\n";
+        kernel += "FRAME_" + id + "_CLASS = 3\n";
+        kernel += "FRAME_" + id + "_CLASS_ID = " + id + "\n";
+        kernel += "FRAME_" + id + "_CENTER = " + id + "\n";
+        kernel += "CK_" + id + "_SCLK = " + std::to_string(FIXTURE_SCLK_ID) + "\n";
+        kernel += "CK_" + id + "_SPK = " + id + "\n";
+        kernel += "OBJECT_" + id + "_FRAME = '" + name + "'\n\n";
+    }
+    return kernel + "\\begintext\n";
+}
+
+// One partition of 2^32 seconds with 1/65536 s ticks, TDB seconds past J2000 at tick 0
+static std::string spacecraftClockKernel() {
+    std::string id = std::to_string(-FIXTURE_SCLK_ID);
+    return "KPL/SCLK\n\n\\begindata\n\n"
+           "SCLK_KERNEL_ID = ( @2026-12-01/00:00 )\n"
+           "SCLK_DATA_TYPE_" + id + " = ( 1 )\n"
+           "SCLK01_TIME_SYSTEM_" + id + " = ( 1 )\n"
+           "SCLK01_N_FIELDS_" + id + " = ( 2 )\n"
+           "SCLK01_MODULI_" + id + " = ( 4294967296 65536 )\n"
+           "SCLK01_OFFSETS_" + id + " = ( 0 0 )\n"
+           "SCLK01_OUTPUT_DELIM_" + id + " = ( 1 )\n"
+           "SCLK_PARTITION_START_" + id + " = ( 0.0 )\n"
+           "SCLK_PARTITION_END_" + id + " = ( 2.81474976710656D14 )\n"
+           "SCLK01_COEFFICIENTS_" + id + " = ( 0.0 0.0 1.0 )\n\n"
+           "\\begintext\n";
+}
+
+// Paths are split into '+' continued pieces, kernel pool strings are limited to 80 characters
+static std::string metaKernel(const std::filesystem::path& directory, const std::vector<std::string>& files) {
+    std::string path = directory.string();
+    std::string kernel = "KPL/MK\n\n\\begindata\n\nPATH_VALUES = ( ";
+    for (size_t offset = 0; offset < path.size(); offset += 60) {
+        kernel += "'" + path.substr(offset, 60) + (offset + 60 < path.size() ? "+'\n                " : "'");
+    }
+    kernel += " )\nPATH_SYMBOLS = ( 'FIXTURES' )\nKERNELS_TO_LOAD = (";
+    for (const std::string& file : files) kernel += "\n    '$FIXTURES/" + file + "'";
+    return kernel + " )\n\n\\begintext\n";
+}
+
+
+
+// ─────────────────────────────────────────────
+// Binary Kernels - CSPICE writers
+// ─────────────────────────────────────────────
+
+static bool writeOrbitKernel(const std::filesystem::path& path, const std::vector<FixtureOrbit>& orbits) {
+    SpiceInt handle;
+    spkopn_c(path.c_str(), "HERA BENCH FIXTURE", 0, &handle);
+    if (spiceFailed("SPK open")) return false;
+
+    SpiceDouble first = fixtureEt(FIXTURE_START_UTC);
+    SpiceDouble span = FIXTURE_END_UTC - FIXTURE_START_UTC;
+    bool written = true;                                // spiceFailed resets the error, the close would hide it
+    for (const FixtureOrbit& orbit : orbits) {
+        SpiceDouble step = std::clamp(orbit.period / FIXTURE_SAMPLES_PER_ORBIT, 60.0, 3600.0);
+        SpiceInt count = static_cast<SpiceInt>(std::ceil(span / step)) + 1;
+
+        std::vector<std::array<SpiceDouble, 6>> states(count);
+        for (SpiceInt i = 0; i < count; i++) orbitState(orbit, i * step, states[i].data());
+
+        spkw08_c(handle, orbit.body, orbit.center, "J2000", first, first + (count - 1) * step, "HERA BENCH ORBIT",
+                 FIXTURE_SPK_DEGREE, count, reinterpret_cast<SpiceDouble(*)[6]>(states.data()), first, step);
+        if (spiceFailed("SPK segment " + std::to_string(orbit.body))) {
+            written = false;
+            break;
+        }
+    }
+
+    spkcls_c(handle);
+    return !spiceFailed("SPK close") && written;
+}
+
+// Euler angles (RA + 90 deg, 90 deg - DEC, W) as degree 1 Chebyshev records, W wrapped per record
+static bool writeAsteroidOrientationKernel(const std::filesystem::path& path) {
+    SpiceInt handle;
+    pckopn_c(path.c_str(), "HERA BENCH FIXTURE", 0, &handle);
+    if (spiceFailed("PCK open")) return false;
+
+    SpiceDouble first = fixtureEt(FIXTURE_START_UTC);
+    SpiceInt count = static_cast<SpiceInt>(std::ceil((FIXTURE_END_UTC - FIXTURE_START_UTC) / FIXTURE_PCK_INTERVAL));
+    bool written = true;
+    for (const auto& [classId, rotation] : asteroidRotations) {
+        SpiceDouble rate = rotation.rate * rpd_c() / spd_c();
+        std::vector<SpiceDouble> coefficients;
+        for (SpiceInt i = 0; i < count; i++) {
+            SpiceDouble middle = (i + 0.5) * FIXTURE_PCK_INTERVAL;
+            coefficients.insert(coefficients.end(), {
+                halfpi_c() + rotation.poleRa * rpd_c(), 0.0,
+                halfpi_c() - rotation.poleDec * rpd_c(), 0.0,
+                std::fmod(rotation.meridian * rpd_c() + rate * middle, twopi_c()), rate * FIXTURE_PCK_INTERVAL / 2.0
+            });
+        }
+
+        pckw02_c(handle, classId, "J2000", first, first + count * FIXTURE_PCK_INTERVAL, "HERA BENCH ROTATION",
+                 FIXTURE_PCK_INTERVAL, count, 1, coefficients.data(), first);
+        if (spiceFailed("PCK segment " + std::to_string(classId))) {
+            written = false;
+            break;
+        }
+    }
+
+    pckcls_c(handle);
+    return !spiceFailed("PCK close") && written;
+}
+
+// Spin about the J2000 z axis, one turn every two hours, with angular velocity for sxform_c
+static bool writeAttitudeKernel(const std::filesystem::path& path, const std::filesystem::path& clockKernel) {
+    furnsh_c(clockKernel.c_str());
+    SpiceInt handle;
+    ckopn_c(path.c_str(), "HERA BENCH FIXTURE", 0, &handle);
+    if (spiceFailed("CK open")) {
+        unload_c(clockKernel.c_str());
+        return false;
+    }
+
+    SpiceDouble first = fixtureEt(FIXTURE_START_UTC);
+    SpiceInt count = static_cast<SpiceInt>(std::ceil((FIXTURE_END_UTC - FIXTURE_START_UTC) / FIXTURE_CK_STEP)) + 1;
+    SpiceDouble rate = twopi_c() / 7200.0;
+    bool written = true;
+
+    for (const FixtureOrbit& orbit : spacecraftOrbits) {
+        std::vector<SpiceDouble> ticks(count);
+        std::vector<std::array<SpiceDouble, 4>> quaternions(count);
+        std::vector<std::array<SpiceDouble, 3>> angularVelocities(count, { 0.0, 0.0, rate });
+        for (SpiceInt i = 0; i < count; i++) {
+            SpiceDouble rotation[3][3];
+            sce2c_c(FIXTURE_SCLK_ID, first + i * FIXTURE_CK_STEP, &ticks[i]);
+            rotate_c(std::fmod(orbit.phase * rpd_c() + rate * i * FIXTURE_CK_STEP, twopi_c()), 3, rotation);
+            m2q_c(rotation, quaternions[i].data());
+        }
+
+        ckw03_c(handle, ticks.front(), ticks.back(), orbit.body, "J2000", SPICETRUE, "HERA BENCH ATTITUDE", count,
+                ticks.data(), reinterpret_cast<SpiceDouble(*)[4]>(quaternions.data()),
+                reinterpret_cast<SpiceDouble(*)[3]>(angularVelocities.data()), 1, ticks.data());
+        if (spiceFailed("CK segment " + std::to_string(orbit.body))) {
+            written = false;
+            break;
+        }
+    }
+
+    ckcls_c(handle);
+    unload_c(clockKernel.c_str());
+    return !spiceFailed("CK close") && written;
+}
+
+
+
+// ─────────────────────────────────────────────
+// Synthetic Kernels - offline stand-in for the ESA kernel set
+// ─────────────────────────────────────────────
+
+bool writeBenchFixtures(const std::filesystem::path& directory) {
+    std::error_code ec;
+    std::filesystem::create_directories(directory, ec);
+    std::filesystem::path root = std::filesystem::absolute(directory, ec);
+
+    // The DAF writers refuse to replace files
+    for (const char* file : { "hera_bench_natural.bsp", "hera_bench_spacecraft.bsp", "hera_bench.bpc", "hera_bench.bc" }) {
+        std::filesystem::remove(root / file, ec);
+    }
+
+    erract_c("SET", 0, const_cast<SpiceChar*>("RETURN"));
+    errprt_c("SET", 0, const_cast<SpiceChar*>("NONE"));
+
+    return writeTextKernel(root / "hera_bench.tls", leapSecondKernel()) &&
+           writeTextKernel(root / "hera_bench.tpc", planetaryConstantsKernel()) &&
+           writeTextKernel(root / "hera_bench.tf", frameKernel()) &&
+           writeTextKernel(root / "hera_bench.tsc", spacecraftClockKernel()) &&
+           writeOrbitKernel(root / "hera_bench_natural.bsp", naturalOrbits) &&
+           writeOrbitKernel(root / "hera_bench_spacecraft.bsp", spacecraftOrbits) &&
+           writeAsteroidOrientationKernel(root / "hera_bench.bpc") &&
+           writeAttitudeKernel(root / "hera_bench.bc", root / "hera_bench.tsc") &&
+           writeTextKernel(root / "hera_bench_crema.tm", metaKernel(root, {
+               "hera_bench.tls", "hera_bench.tpc", "hera_bench.tf", "hera_bench_natural.bsp", "hera_bench.bpc" })) &&
+           writeTextKernel(root / "hera_bench_ops.tm", metaKernel(root, { "hera_bench.tsc", "hera_bench.bc" })) &&
+           writeTextKernel(root / "hera_bench_plan.tm", metaKernel(root, { "hera_bench_spacecraft.bsp" }));
+}
+
+void useBenchFixtures(const std::filesystem::path& directory) {
+    std::error_code ec;
+    std::filesystem::path root = std::filesystem::absolute(directory, ec);
+
+    cremaMetakernel = root / "hera_bench_crema.tm";
+    operationalMetakernel = root / "hera_bench_ops.tm";
+    planMetakernel = root / "hera_bench_plan.tm";
+    kernelPathsLoaded = true;                   // initSpiceCore keeps these instead of data/hera
+}
@@ -0,0 +1,49 @@
+/*
+ *  Copyright 2025 Mendel Dobondi-Reisz
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef BENCH_FIXTURES_HPP
+#define BENCH_FIXTURES_HPP
+
+// Standard C++ Libraries
+#include <filesystem>
+
+// ─────────────────────────────────────────────
+// Fixture Parameters
+// ─────────────────────────────────────────────
+#define FIXTURE_START_UTC 1796083200.0          // 2026-12-01T00:00:00 UTC
+#define FIXTURE_END_UTC 1806537600.0            // 2027-04-01T00:00:00 UTC, covers every case from the default start
+#define FIXTURE_SPK_DEGREE 7                    // Lagrange degree of the type 8 segments
+#define FIXTURE_SAMPLES_PER_ORBIT 64            // SPK states per orbital period, at most one per hour
+#define FIXTURE_CK_STEP 600.0                   // Seconds between CK attitude records
+#define FIXTURE_PCK_INTERVAL 86400.0            // Seconds per binary PCK record
+#define FIXTURE_SCLK_ID -91                     // One clock for every spacecraft
+#define FIXTURE_ENVIRONMENT "HERA_BENCH_FIXTURES"   // Fixture directory, inherited by SPICE worker processes
+
+// ─────────────────────────────────────────────
+// Synthetic Kernels - offline stand-in for the ESA kernel set
+// ─────────────────────────────────────────────
+
+/*
+ * Writes LSK, text and binary PCK, FK, SCLK, SPK and CK kernels for every default object into 'directory',
+ * with circular orbits and constant spins, and three meta-kernels in the layout of data/hera.
+ * Binary kernels go through the CSPICE writers, text kernels are written as plain files.
+ */
+bool writeBenchFixtures(const std::filesystem::path& directory);
+
+// Points initSpiceCore at the fixture meta-kernels instead of data/hera
+void useBenchFixtures(const std::filesystem::path& directory);
+
+#endif // BENCH_FIXTURES_HPP
@@ -0,0 +1,857 @@
+/*
+ *  Copyright 2025 Mendel Dobondi-Reisz
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+// Standard C++ Libraries
+#include <algorithm>
+#include <new>
+#include <atomic>
+#include <cstdlib>
+#include <array>
+#include <iostream>
+#include <iomanip>
+#include <cstring>
+#include <cstdint>
+#include <chrono>
+#include <cmath>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fstream>
+#include <filesystem>
+
+// Project Headers
+#include "bench_fixtures.hpp"
+#include <barycentric_table.hpp>
+#include <ephemeris_snapshot.hpp>
+#include <object_catalog.hpp>
+#include <light_time.hpp>
+#include <response_encoding.hpp>
+#include <request_trace.hpp>
+#include <worker_pool.hpp>
+#include <spice_core.hpp>
+#include <utils.hpp>
+
+
+
+// ─────────────────────────────────────────────
+// Allocation Counter - every operator new of the benchmark process
+// ─────────────────────────────────────────────
+
+static std::atomic<size_t> allocationCount = 0;
+
+void* operator new(size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* pointer = std::malloc(size ? size : 1)) return pointer;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept {
+    std::free(pointer);
+}
+
+
+
+// ─────────────────────────────────────────────
+// Benchmark Helpers
+// ─────────────────────────────────────────────
+
+using BenchClock = std::chrono::steady_clock;
+
+struct BenchOptions {
+    int maxWorkers = static_cast<int>(std::thread::hardware_concurrency());
+    int requests = 20000;
+    double startTimestamp = 1798761600.0;   // 2027-01-01T00:00:00 UTC, inside the HERA operations window
+    int observerId = -91000;                // HERA_SPACECRAFT
+    std::string benchCase = "all";          // workers, time, ssb, lt, encoding, alloc, multi, snapshot, micro or all
+    std::string fixtures;                   // Synthetic kernels are written to and loaded from here, data/hera if empty
+    std::string jsonPath;                   // Results are also written here as JSON
+};
+
+static std::string makeRequest(double utcTimestamp, MessageMode mode, int32_t observerId) {
+    std::string request(EXPECTED_MESSAGE_LENGTH, '\0');
+    std::memcpy(request.data(), &utcTimestamp, sizeof(utcTimestamp));
+    request[sizeof(utcTimestamp)] = static_cast<char>(mode);
+    std::memcpy(request.data() + sizeof(utcTimestamp) + sizeof(mode), &observerId, sizeof(observerId));
+    return request;
+}
+
+static std::vector<std::string> makeRequests(const BenchOptions& options) {
+    std::vector<std::string> requests;
+    requests.reserve(options.requests);
+    for (int i = 0; i < options.requests; i++) {
+        requests.push_back(makeRequest(options.startTimestamp + 60.0 * i, MessageMode::ALL_INSTANTANEOUS, options.observerId));
+    }
+    return requests;
+}
+
+static double secondsSince(BenchClock::time_point start) {
+    return std::chrono::duration<double>(BenchClock::now() - start).count();
+}
+
+
+
+// ─────────────────────────────────────────────
+// Benchmark Results - machine-readable copy of the printed numbers
+// ─────────────────────────────────────────────
+
+struct BenchResult {
+    std::string benchCase;
+    std::string metric;
+    double value;
+    std::string unit;
+};
+
+static std::vector<BenchResult> benchResults;
+
+static void recordResult(const std::string& benchCase, const std::string& metric, double value, const std::string& unit) {
+    benchResults.push_back({ benchCase, metric, std::isfinite(value) ? value : 0.0, unit });
+}
+
+static std::string jsonString(const std::string& text) {
+    std::string quoted = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') quoted += '\\';
+        quoted += c;
+    }
+    return quoted + "\"";
+}
+
+static bool writeJsonResults(const BenchOptions& options) {
+    std::ofstream file(options.jsonPath, std::ios::trunc);
+    file << "{\n  \"kernels\": " << jsonString(options.fixtures.empty() ? "data/hera" : options.fixtures) << ",\n"
+         << "  \"requests\": " << options.requests << ",\n"
+         << "  \"observer\": " << options.observerId << ",\n"
+         << "  \"results\": [";
+    for (size_t i = 0; i < benchResults.size(); i++) {
+        const BenchResult& result = benchResults[i];
+        file << (i ? "," : "") << "\n    { \"case\": " << jsonString(result.benchCase)
+             << ", \"metric\": " << jsonString(result.metric)
+             << ", \"value\": " << std::setprecision(17) << result.value
+             << ", \"unit\": " << jsonString(result.unit) << " }";
+    }
+    file << "\n  ]\n}\n";
+    return static_cast<bool>(file);
+}
+
+
+
+// ─────────────────────────────────────────────
+// Worker Pool Scaling
+// ─────────────────────────────────────────────
+
+static double runInProcess(const std::vector<std::string>& requests, int requestsPerFrame = 1) {
+    std::string responseBuffer;
+    auto start = BenchClock::now();
+    for (const auto& request : requests) processRequest(request, responseBuffer);
+    return requests.size() * requestsPerFrame / secondsSince(start);
+}
+
+static double runWorkerPool(int workerCount, const std::vector<std::string>& requests, int requestsPerFrame = 1) {
+    WorkerPool pool(workerCount);
+    if (!pool.start()) return 0.0;
+    pool.publishKernels();
+
+    auto deadline = BenchClock::now() + std::chrono::minutes(2);
+    while (pool.readyWorkers() < pool.size()) {
+        if (BenchClock::now() > deadline) return 0.0;
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    size_t submitted = 0;
+    size_t completed = 0;
+    auto onResponse = [&](uint64_t, std::string&&) { completed++; };
+
+    auto start = BenchClock::now();
+    while (completed < requests.size()) {
+        while (submitted < requests.size() && pool.submit(submitted, requests[submitted])) submitted++;
+        pool.poll(onResponse);
+    }
+    return requests.size() * requestsPerFrame / secondsSince(start);
+}
+
+static void benchWorkerScaling(const BenchOptions& options) {
+    std::vector<std::string> requests = makeRequests(options);
+
+    std::cout << "\nWorker pool scaling (" << requests.size() << " 'i' requests, observer "
+              << options.observerId << ")\n\n";
+    std::cout << std::setw(10) << "workers" << std::setw(16) << "requests/s"
+              << std::setw(12) << "speedup" << std::setw(14) << "efficiency" << "\n";
+
+    double inProcess = runInProcess(requests);
+    recordResult("workers", "in-process", inProcess, "requests/s");
+    std::cout << std::setw(10) << "in-proc" << std::setw(16) << std::fixed << std::setprecision(0) << inProcess
+              << std::setw(12) << "-" << std::setw(14) << "-" << "\n";
+
+    double single = 0.0;
+    for (int workers = 1; workers <= options.maxWorkers; workers++) {
+        double throughput = runWorkerPool(workers, requests);
+        if (workers == 1) single = throughput;
+        recordResult("workers", std::to_string(workers) + " workers", throughput, "requests/s");
+
+        double speedup = single > 0.0 ? throughput / single : 0.0;
+        std::cout << std::setw(10) << workers
+                  << std::setw(16) << std::setprecision(0) << throughput
+                  << std::setw(12) << std::setprecision(2) << speedup
+                  << std::setw(13) << std::setprecision(0) << 100.0 * speedup / workers << "%\n"
+                  << std::flush;
+    }
+}
+
+
+
+// ─────────────────────────────────────────────
+// UTC -> ET Conversion
+// ─────────────────────────────────────────────
+
+#define MISSION_SPAN_START 1728259200.0     // 2024-10-07T00:00:00 UTC, launch
+#define MISSION_SPAN_END 1830297600.0       // 2028-01-01T00:00:00 UTC, end of the extended mission
+#define TIME_EQUIVALENCE_TOLERANCE 1e-6     // Seconds
+
+static bool benchTimeConversion(const BenchOptions& options) {
+    std::vector<double> timestamps(options.requests);
+    for (int i = 0; i < options.requests; i++) timestamps[i] = options.startTimestamp + 61.37 * i;
+
+    volatile SpiceDouble sink = 0.0;
+    auto start = BenchClock::now();
+    for (double timestamp : timestamps) sink = sink + etTimeFromString(timestamp);
+    double stringNs = 1e9 * secondsSince(start) / timestamps.size();
+
+    start = BenchClock::now();
+    for (double timestamp : timestamps) sink = sink + etTime(timestamp);
+    double arithmeticNs = 1e9 * secondsSince(start) / timestamps.size();
+
+    recordResult("time", "utcTimeString+str2et_c", stringNs, "ns/op");
+    recordResult("time", "leap second table", arithmeticNs, "ns/op");
+
+    std::cout << "\nUTC -> ET conversion (" << timestamps.size() << " timestamps)\n\n";
+    std::cout << std::setw(24) << "utcTimeString+str2et_c" << std::setw(12) << std::fixed << std::setprecision(1)
+              << stringNs << " ns/op\n";
+    std::cout << std::setw(24) << "leap second table" << std::setw(12) << arithmeticNs << " ns/op"
+              << (leapSeconds.loaded ? "" : "  (no LSK loaded: str2et_c fallback)") << "\n";
+    std::cout << std::setw(24) << "speedup" << std::setw(12) << std::setprecision(1) << stringNs / arithmeticNs << "x\n";
+
+    // Equivalence over the whole mission, hourly plus a fractional second and both sides of every leap
+    std::vector<double> sweep;
+    for (double timestamp = MISSION_SPAN_START; timestamp < MISSION_SPAN_END; timestamp += 3600.0) {
+        sweep.push_back(timestamp);
+        sweep.push_back(timestamp + 0.25);
+    }
+    for (const auto& [leapUtc, deltaAt] : leapSeconds.deltaAt) {
+        double leapUnix = leapUtc + 946728000.0;
+        sweep.push_back(leapUnix - 0.5);
+        sweep.push_back(leapUnix + 0.5);
+    }
+
+    double worst = 0.0, worstTimestamp = 0.0;
+    for (double timestamp : sweep) {
+        double difference = std::fabs(etTime(timestamp) - etTimeFromString(timestamp));
+        if (difference > worst) {
+            worst = difference;
+            worstTimestamp = timestamp;
+        }
+    }
+
+    recordResult("time", "max |delta ET|", worst, "s");
+
+    std::cout << "\nEquivalence vs str2et_c (" << sweep.size() << " epochs, 2024-10-07 to 2028-01-01)\n\n";
+    std::cout << std::setw(24) << "max |delta ET|" << std::setw(12) << std::scientific << std::setprecision(2)
+              << worst << " s at " << std::fixed << std::setprecision(2) << worstTimestamp << "\n";
+    bool pass = worst <= TIME_EQUIVALENCE_TOLERANCE;
+    std::cout << std::setw(24) << "result" << std::setw(12) << (pass ? "PASS" : "FAIL") << "\n" << std::flush;
+    return pass;
+}
+
+
+
+// ─────────────────────────────────────────────
+// Barycentric Table vs spkez_c
+// ─────────────────────────────────────────────
+
+#define BARYCENTRIC_EPOCHS 2000
+#define BARYCENTRIC_POSITION_TOLERANCE 1e-6 // km
+
+static bool benchBarycentricTable(const BenchOptions& options) {
+    std::vector<SpiceDouble> epochs;
+    for (int i = 0; i < BARYCENTRIC_EPOCHS; i++) epochs.push_back(etTime(options.startTimestamp + 3607.3 * i));
+
+    // Reference: one spkez_c per body, as before the table
+    std::vector<std::vector<std::array<SpiceDouble, 6>>> reference(epochs.size());
+    std::vector<std::vector<bool>> referenceAvailable(epochs.size());
+    auto start = BenchClock::now();
+    for (size_t e = 0; e < epochs.size(); e++) {
+        for (const CatalogObject& object : objectCatalog) {
+            std::array<SpiceDouble, 6> state;
+            SpiceDouble lt;
+            spkez_c(object.id, epochs[e], "J2000", "NONE", options.observerId, state.data(), &lt);
+            referenceAvailable[e].push_back(!failed_c());
+            if (failed_c()) reset_c();
+            reference[e].push_back(state);
+        }
+    }
+    double spkezUs = 1e6 * secondsSince(start) / epochs.size();
+
+    size_t compared = 0, exact = 0, mismatched = 0;
+    double worstPosition = 0.0, worstVelocity = 0.0, worstRelative = 0.0;
+    start = BenchClock::now();
+    for (size_t e = 0; e < epochs.size(); e++) {
+        barycentricTable.prepare(epochs[e], ~uint64_t(0));
+        for (const CatalogObject& object : objectCatalog) {
+            SpiceDouble state[6];
+            bool available = barycentricTable.relativeState(object, options.observerId, state);
+            if (available != referenceAvailable[e][object.index]) {
+                mismatched++;
+                continue;
+            }
+            if (!available) continue;
+
+            const auto& expected = reference[e][object.index];
+            SpiceDouble position = 0.0, velocity = 0.0, distance = 0.0;
+            bool bitExact = true;
+            for (int i = 0; i < 3; i++) {
+                position += (state[i] - expected[i]) * (state[i] - expected[i]);
+                velocity += (state[i + 3] - expected[i + 3]) * (state[i + 3] - expected[i + 3]);
+                distance += expected[i] * expected[i];
+            }
+            for (int i = 0; i < 6; i++) bitExact &= state[i] == expected[i];
+
+            compared++;
+            exact += bitExact;
+            worstPosition = std::max(worstPosition, std::sqrt(position));
+            worstVelocity = std::max(worstVelocity, std::sqrt(velocity));
+            if (distance > 0.0) worstRelative = std::max(worstRelative, std::sqrt(position / distance));
+        }
+    }
+    double tableUs = 1e6 * secondsSince(start) / epochs.size();
+    invalidateBarycentricTable();
+    recordResult("ssb", "spkez_c per body", spkezUs, "us/epoch");
+    recordResult("ssb", "SSB table + difference", tableUs, "us/epoch");
+    recordResult("ssb", "max |delta position|", worstPosition, "km");
+
+    std::cout << "\nBarycentric table vs spkez_c 'NONE' (" << epochs.size() << " epochs, "
+              << objectCatalog.size() << " objects, observer " << options.observerId << ")\n\n";
+    std::cout << std::setw(24) << "spkez_c per body" << std::setw(12) << std::fixed << std::setprecision(1)
+              << spkezUs << " us/epoch\n";
+    std::cout << std::setw(24) << "SSB table + difference" << std::setw(12) << tableUs << " us/epoch\n";
+    std::cout << std::setw(24) << "bit-exact states" << std::setw(12) << exact << " / " << compared << "\n";
+    std::cout << std::setw(24) << "availability mismatch" << std::setw(12) << mismatched << "\n";
+    std::cout << std::setw(24) << "max |delta position|" << std::setw(12) << std::scientific << std::setprecision(2)
+              << worstPosition << " km (relative " << worstRelative << ")\n";
+    std::cout << std::setw(24) << "max |delta velocity|" << std::setw(12) << worstVelocity << " km/s\n";
+    bool pass = worstPosition <= BARYCENTRIC_POSITION_TOLERANCE && mismatched == 0;
+    std::cout << std::setw(24) << "result" << std::setw(12) << (pass ? "PASS" : "FAIL") << "\n" << std::flush;
+    return pass;
+}
+
+
+
+// ─────────────────────────────────────────────
+// Light Time Engine vs spkez_c
+// ─────────────────────────────────────────────
+
+static bool benchLightTimeEngine(const BenchOptions& options) {
+    std::vector<SpiceDouble> epochs;
+    for (int i = 0; i < BARYCENTRIC_EPOCHS; i++) epochs.push_back(etTime(options.startTimestamp + 3607.3 * i));
+
+    std::vector<std::vector<std::array<SpiceDouble, 7>>> reference(epochs.size());     // state + lt
+    std::vector<std::vector<bool>> referenceAvailable(epochs.size());
+    auto start = BenchClock::now();
+    for (size_t e = 0; e < epochs.size(); e++) {
+        for (const CatalogObject& object : objectCatalog) {
+            std::array<SpiceDouble, 7> state;
+            spkez_c(object.id, epochs[e], "J2000", "LT+S", options.observerId, state.data(), &state[6]);
+            referenceAvailable[e].push_back(!failed_c());
+            if (failed_c()) reset_c();
+            reference[e].push_back(state);
+        }
+    }
+    double spkezUs = 1e6 * secondsSince(start) / epochs.size();
+
+    size_t compared = 0, mismatched = 0;
+    double worstPosition = 0.0, worstVelocity = 0.0, worstLightTime = 0.0;
+    start = BenchClock::now();
+    for (size_t e = 0; e < epochs.size(); e++) {
+        bool solved = lightTimeEngine.solve(epochs[e], options.observerId, ~uint64_t(0));
+        for (const CatalogObject& object : objectCatalog) {
+            SpiceDouble state[6], lt;
+            bool available = solved && lightTimeEngine.correctedState(object, state, lt);
+            if (available != referenceAvailable[e][object.index]) {
+                mismatched++;
+                continue;
+            }
+            if (!available) continue;
+
+            const auto& expected = reference[e][object.index];
+            SpiceDouble position = 0.0, velocity = 0.0;
+            for (int i = 0; i < 3; i++) {
+                position += (state[i] - expected[i]) * (state[i] - expected[i]);
+                velocity += (state[i + 3] - expected[i + 3]) * (state[i + 3] - expected[i + 3]);
+            }
+            compared++;
+            worstPosition = std::max(worstPosition, std::sqrt(position));
+            worstVelocity = std::max(worstVelocity, std::sqrt(velocity));
+            worstLightTime = std::max(worstLightTime, std::fabs(lt - expected[6]));
+        }
+    }
+    double engineUs = 1e6 * secondsSince(start) / epochs.size();
+    invalidateLightTimeEngine();
+    invalidateBarycentricTable();
+    recordResult("lt", "spkez_c per body", spkezUs, "us/epoch");
+    recordResult("lt", "batched engine", engineUs, "us/epoch");
+    recordResult("lt", "max |delta position|", worstPosition, "km");
+
+    bool pass = mismatched == 0 && worstPosition <= LIGHT_TIME_POSITION_TOLERANCE &&
+                worstVelocity <= LIGHT_TIME_VELOCITY_TOLERANCE && worstLightTime <= LIGHT_TIME_TOLERANCE;
+
+    std::cout << "\nLight time engine vs spkez_c 'LT+S' (" << epochs.size() << " epochs, "
+              << objectCatalog.size() << " objects, observer " << options.observerId << ")\n\n";
+    std::cout << std::setw(24) << "spkez_c per body" << std::setw(12) << std::fixed << std::setprecision(1)
+              << spkezUs << " us/epoch\n";
+    std::cout << std::setw(24) << "batched engine" << std::setw(12) << engineUs << " us/epoch\n";
+    std::cout << std::setw(24) << "compared states" << std::setw(12) << compared << "\n";
+    std::cout << std::setw(24) << "availability mismatch" << std::setw(12) << mismatched << "\n";
+    std::cout << std::setw(24) << "max |delta position|" << std::setw(12) << std::scientific << std::setprecision(2)
+              << worstPosition << " km (limit " << LIGHT_TIME_POSITION_TOLERANCE << ")\n";
+    std::cout << std::setw(24) << "max |delta velocity|" << std::setw(12) << worstVelocity
+              << " km/s (limit " << LIGHT_TIME_VELOCITY_TOLERANCE << ")\n";
+    std::cout << std::setw(24) << "max |delta lt|" << std::setw(12) << worstLightTime
+              << " s (limit " << LIGHT_TIME_TOLERANCE << ")\n";
+    std::cout << std::setw(24) << "result" << std::setw(12) << (pass ? "PASS" : "FAIL") << "\n" << std::flush;
+    return pass;
+}
+
+
+
+// ─────────────────────────────────────────────
+// Response Encodings
+// ─────────────────────────────────────────────
+
+#define ENCODING_FRAME_RATE 60.0            // Frames per second of the simulated stream
+
+static void benchResponseEncoding(const BenchOptions& options) {
+    // A 60 Hz real-time stream, as a subscription would push it
+    std::vector<std::string> responses;
+    responses.reserve(options.requests);
+    for (int i = 0; i < options.requests; i++) {
+        RequestHandler requestHandler(makeRequest(options.startTimestamp + i / ENCODING_FRAME_RATE,
+                                                  MessageMode::ALL_INSTANTANEOUS, options.observerId));
+        responses.push_back(requestHandler.getMessage());
+    }
+
+    size_t rawBytes = 0;
+    for (const auto& response : responses) rawBytes += response.size();
+
+    std::cout << "\nResponse encodings (" << responses.size() << " frames at " << ENCODING_FRAME_RATE
+              << " Hz, observer " << options.observerId << ")\n\n";
+    std::cout << std::setw(24) << "encoding" << std::setw(14) << "bytes/frame"
+              << std::setw(12) << "of raw" << std::setw(14) << "ns/frame" << "\n";
+
+    const std::array<std::pair<const char*, uint8_t>, 8> encodings = {{
+        { "raw double", 0 },
+        { "float32", ENCODING_FLOAT32 },
+        { "quat16", ENCODING_QUAT16 },
+        { "float32+quat16", ENCODING_FLOAT32 | ENCODING_QUAT16 },
+        { "delta", ENCODING_DELTA },
+        { "delta+float32", ENCODING_DELTA | ENCODING_FLOAT32 },
+        { "delta+quat16", ENCODING_DELTA | ENCODING_QUAT16 },
+        { "delta+float32+quat16", ENCODING_ALL }
+    }};
+
+    for (const auto& [name, encoding] : encodings) {
+        EncodingState state;
+        state.encoding = encoding;
+        std::string frame;
+        size_t bytes = 0;
+
+        auto start = BenchClock::now();
+        for (const auto& response : responses) {
+            bytes += encodeResponse(response, COMPONENT_ALL, state, frame) ? frame.size() : response.size();
+        }
+        double ns = 1e9 * secondsSince(start) / responses.size();
+        recordResult("encoding", std::string(name) + " size", static_cast<double>(bytes) / responses.size(), "bytes/frame");
+        recordResult("encoding", std::string(name) + " time", ns, "ns/frame");
+
+        std::cout << std::setw(24) << name
+                  << std::setw(14) << std::fixed << std::setprecision(1) << static_cast<double>(bytes) / responses.size()
+                  << std::setw(11) << 100.0 * bytes / rawBytes << "%"
+                  << std::setw(14) << ns << "\n" << std::flush;
+    }
+}
+
+
+
+// ─────────────────────────────────────────────
+// Steady-State Request Allocations
+// ─────────────────────────────────────────────
+
+#define ALLOCATION_WARMUP_REQUESTS 16
+
+static bool benchRequestAllocations(const BenchOptions& options) {
+    std::cout << "\nHeap allocations per request (" << options.requests << " requests after "
+              << ALLOCATION_WARMUP_REQUESTS << " warm-up, observer " << options.observerId << ")\n\n";
+    std::cout << std::setw(24) << "path" << std::setw(16) << "allocations" << std::setw(12) << "result" << "\n";
+
+    // Frames as a loop thread sends them: as computed, encoded with deltas, and zstd compressed
+    const std::array<std::pair<const char*, uint8_t>, 3> encodings = {{
+        { "send raw", 0 },
+        { "send delta", ENCODING_FLOAT32 | ENCODING_QUAT16 | ENCODING_DELTA },
+        { "send zstd", ENCODING_ZSTD }
+    }};
+    size_t compressThreshold = serverOptions.compressThreshold;
+    serverOptions.compressThreshold = 0;                    // Every frame goes through zstd with ENCODING_ZSTD
+
+    bool pass = true;
+    auto report = [&pass](const std::string& name, size_t allocations) {
+        pass &= allocations == 0;
+        recordResult("alloc", name, static_cast<double>(allocations), "allocations");
+        std::cout << std::setw(24) << name << std::setw(16) << allocations << std::setw(12) << (allocations == 0 ? "PASS" : "FAIL") << "\n";
+    };
+
+    for (MessageMode mode : { MessageMode::ALL_INSTANTANEOUS, MessageMode::ALL_LIGHT_TIME_ADJUSTED }) {
+        std::string label = mode == MessageMode::ALL_INSTANTANEOUS ? "'i'" : "'l'";
+        std::vector<std::string> requests;
+        for (int i = 0; i < ALLOCATION_WARMUP_REQUESTS + options.requests; i++) {
+            requests.push_back(makeRequest(options.startTimestamp + 60.0 * i, mode, options.observerId));
+        }
+
+        // Entry point of the compute thread and the workers, one response buffer for every request.
+        // Not covered: the hand-over between the threads, which copies the response for the event loop
+        // and allocates the deferred send.
+        std::string responseBuffer;
+        for (int i = 0; i < ALLOCATION_WARMUP_REQUESTS; i++) processRequest(requests[i], responseBuffer);
+
+        size_t before = allocationCount.load();
+        for (size_t i = ALLOCATION_WARMUP_REQUESTS; i < requests.size(); i++) processRequest(requests[i], responseBuffer);
+        report(label + " compute", allocationCount.load() - before);
+
+        // Serialization of writeResponse on a connection with the encoding, up to the socket write
+        for (const auto& [name, encoding] : encodings) {
+            EncodingState state;
+            state.encoding = encoding;
+            bool large;
+            size_t allocations = 0;
+            for (size_t i = 0; i < requests.size(); i++) {
+                std::string_view response = processRequest(requests[i], responseBuffer);
+                before = allocationCount.load();
+                serializeFrame(response, COMPONENT_ALL, state, large);
+                if (i >= ALLOCATION_WARMUP_REQUESTS) allocations += allocationCount.load() - before;
+            }
+            report(label + " " + name, allocations);
+        }
+    }
+    serverOptions.compressThreshold = compressThreshold;
+    invalidateLightTimeEngine();
+    invalidateBarycentricTable();
+
+    std::cout << std::setw(24) << "result" << std::setw(28) << (pass ? "PASS" : "FAIL") << "\n" << std::flush;
+    return pass;
+}
+
+
+
+// ─────────────────────────────────────────────
+// Multi-Request Frames
+// ─────────────────────────────────────────────
+
+#define MULTI_BENCH_REQUESTS_PER_FRAME 16
+
+static void benchMultiRequests(const BenchOptions& options) {
+    std::vector<std::string> singles = makeRequests(options);
+
+    // The same requests, packed 16 to a frame
+    std::vector<std::string> frames;
+    for (size_t i = 0; i + MULTI_BENCH_REQUESTS_PER_FRAME <= singles.size(); i += MULTI_BENCH_REQUESTS_PER_FRAME) {
+        std::string frame = { MULTI_REQUEST_COMMAND, static_cast<char>(MULTI_BENCH_REQUESTS_PER_FRAME) };
+        for (int k = 0; k < MULTI_BENCH_REQUESTS_PER_FRAME; k++) frame += singles[i + k];
+        frames.push_back(std::move(frame));
+    }
+    singles.resize(frames.size() * MULTI_BENCH_REQUESTS_PER_FRAME);
+
+    std::cout << "\nMulti-request frames (" << singles.size() << " 'i' requests, "
+              << MULTI_BENCH_REQUESTS_PER_FRAME << " per frame, observer " << options.observerId << ")\n\n";
+    std::cout << std::setw(24) << "path" << std::setw(16) << "single/s" << std::setw(16) << "multi/s"
+              << std::setw(12) << "speedup" << "\n";
+
+    auto report = [](const std::string& path, double single, double multi) {
+        recordResult("multi", path + " single", single, "requests/s");
+        recordResult("multi", path + " multi", multi, "requests/s");
+        std::cout << std::setw(24) << path << std::setw(16) << std::fixed << std::setprecision(0) << single
+                  << std::setw(16) << multi << std::setw(12) << std::setprecision(2)
+                  << (single > 0.0 ? multi / single : 0.0) << "\n" << std::flush;
+    };
+
+    report("in-process", runInProcess(singles), runInProcess(frames, MULTI_BENCH_REQUESTS_PER_FRAME));
+    report(std::to_string(options.maxWorkers) + " workers", runWorkerPool(options.maxWorkers, singles),
+           runWorkerPool(options.maxWorkers, frames, MULTI_BENCH_REQUESTS_PER_FRAME));
+}
+
+
+
+// ─────────────────────────────────────────────
+// Ephemeris Snapshot vs SPICE
+// ─────────────────────────────────────────────
+
+#define SNAPSHOT_BENCH_SEGMENT 21600.0      // Seconds per snapshot segment
+
+static bool benchEphemerisSnapshot(const BenchOptions& options) {
+    serverOptions.snapshotSegment = SNAPSHOT_BENCH_SEGMENT;
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "hera_bench.snapshot";
+    const std::string version = "hera_bench";
+
+    auto start = BenchClock::now();
+    EphemerisSnapshot snapshot;
+    if (!writeEphemerisSnapshot(path, version) || !loadEphemerisSnapshot(path, version) || !snapshot.map(path)) {
+        std::cerr << "\nEphemeris snapshot could not be written to " << path << "\n" << std::flush;
+        return false;
+    }
+    double writeSeconds = secondsSince(start);
+
+    std::vector<SpiceDouble> epochs;
+    for (int i = 0; i < BARYCENTRIC_EPOCHS; i++) epochs.push_back(etTime(options.startTimestamp + 3607.3 * i));
+
+    size_t compared = 0, uncovered = 0;
+    double worstPosition = 0.0, worstVelocity = 0.0, worstAngle = 0.0;
+    for (SpiceDouble et : epochs) {
+        for (const CatalogObject& object : objectCatalog) {
+            if (!object.hasEphemeris || !object.hasOrientation) continue;
+
+            MotionState fitted, exact;
+            if (!snapshot.relativeState(et, object.index, options.observerId, fitted)) {
+                uncovered++;
+                continue;
+            }
+            if (!computeMotionState(et, object.id, options.observerId, false, object.frameName.c_str(), exact)) continue;
+
+            const Quaternion& a = fitted.orientation;
+            const Quaternion& b = exact.orientation;
+            double dot = std::fabs(a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w);
+            compared++;
+            worstPosition = std::max(worstPosition, std::hypot(fitted.position.x - exact.position.x, fitted.position.y - exact.position.y,
+                                                               fitted.position.z - exact.position.z));
+            worstVelocity = std::max(worstVelocity, std::hypot(fitted.velocity.x - exact.velocity.x, fitted.velocity.y - exact.velocity.y,
+                                                               fitted.velocity.z - exact.velocity.z));
+            worstAngle = std::max(worstAngle, 2.0 * std::acos(std::min(1.0, dot)));
+        }
+    }
+
+    // Request throughput of the loop-thread path against the compute path
+    std::vector<std::string> requests = makeRequests(options);
+    std::string response;
+    size_t answered = 0;
+    start = BenchClock::now();
+    for (const auto& request : requests) answered += answerFromSnapshot(request, response);
+    double snapshotRate = requests.size() / secondsSince(start);
+    double spiceRate = runInProcess(requests);
+
+    unloadEphemerisSnapshot();
+    recordResult("snapshot", "snapshot", snapshotRate, "requests/s");
+    recordResult("snapshot", "SPICE", spiceRate, "requests/s");
+    recordResult("snapshot", "max |delta position|", worstPosition, "km");
+    std::error_code ec;
+    size_t fileSize = std::filesystem::file_size(path, ec);
+    std::filesystem::remove(path, ec);
+
+    std::cout << "\nEphemeris snapshot vs computeMotionState (" << epochs.size() << " epochs, "
+              << objectCatalog.size() << " objects, observer " << options.observerId << ")\n\n";
+    std::cout << std::setw(24) << "segment / write time" << std::setw(12) << std::fixed << std::setprecision(0)
+              << SNAPSHOT_BENCH_SEGMENT << " s / " << std::setprecision(1) << writeSeconds << " s\n";
+    std::cout << std::setw(24) << "file size" << std::setw(12) << fileSize / (1024.0 * 1024.0) << " MiB\n";
+    std::cout << std::setw(24) << "compared / uncovered" << std::setw(12) << compared << " / " << uncovered << "\n";
+    std::cout << std::setw(24) << "requests answered" << std::setw(12) << answered << " / " << requests.size() << "\n";
+    std::cout << std::setw(24) << "snapshot" << std::setw(12) << std::setprecision(0) << snapshotRate << " req/s\n";
+    std::cout << std::setw(24) << "SPICE" << std::setw(12) << spiceRate << " req/s\n";
+    std::cout << std::setw(24) << "max |delta position|" << std::setw(12) << std::scientific << std::setprecision(2)
+              << worstPosition << " km\n";
+    std::cout << std::setw(24) << "max |delta velocity|" << std::setw(12) << worstVelocity << " km/s\n";
+    std::cout << std::setw(24) << "max rotation angle" << std::setw(12) << worstAngle << " rad\n";
+    bool pass = compared > 0 && worstPosition <= 2.0 * SNAPSHOT_TOLERANCE;
+    std::cout << std::setw(24) << "result" << std::setw(12) << (pass ? "PASS" : "FAIL") << "\n" << std::flush;
+    return pass;
+}
+
+
+
+// ─────────────────────────────────────────────
+// Hot Path Microbenchmarks
+// ─────────────────────────────────────────────
+
+#define MICRO_EPOCHS 2000                   // Epochs for the SPICE-bound functions
+#define MICRO_REPETITIONS 3                 // Best of, against scheduler noise
+
+template <typename Body>
+static double bestNsPerOp(size_t operations, Body body) {
+    double best = 0.0;
+    for (int r = 0; r < MICRO_REPETITIONS; r++) {
+        auto start = BenchClock::now();
+        body();
+        double ns = 1e9 * secondsSince(start) / operations;
+        if (r == 0 || ns < best) best = ns;
+    }
+    return best;
+}
+
+static void benchHotPath(const BenchOptions& options) {
+    std::vector<double> timestamps(options.requests);
+    for (int i = 0; i < options.requests; i++) timestamps[i] = options.startTimestamp + 61.37 * i;
+
+    std::vector<SpiceDouble> epochs;
+    for (int i = 0; i < std::min(options.requests, MICRO_EPOCHS); i++) epochs.push_back(etTime(timestamps[i]));
+
+    std::vector<const CatalogObject*> objects;
+    for (const CatalogObject& object : objectCatalog) {
+        if (object.hasEphemeris && object.hasOrientation) objects.push_back(&object);
+    }
+    if (objects.empty()) {
+        std::cerr << "\nNo catalog object has SPICE data, hot path benchmarks skipped\n" << std::flush;
+        return;
+    }
+
+    std::vector<std::pair<std::string, double>> rows;
+    volatile SpiceDouble sink = 0.0;
+    volatile size_t sizeSink = 0;
+
+    rows.emplace_back("etTime", bestNsPerOp(timestamps.size(), [&] {
+        for (double timestamp : timestamps) sink = sink + etTime(timestamp);
+    }));
+    rows.emplace_back("utcTimeString", bestNsPerOp(timestamps.size(), [&] {
+        for (double timestamp : timestamps) sizeSink = sizeSink + utcTimeString(timestamp).size();
+    }));
+
+    size_t frameRounds = std::max<size_t>(1, timestamps.size() / objectCatalog.size());
+    rows.emplace_back("getBodyFixedFrameName", bestNsPerOp(frameRounds * objectCatalog.size(), [&] {
+        for (size_t r = 0; r < frameRounds; r++) {
+            for (const CatalogObject& object : objectCatalog) sizeSink = sizeSink + getBodyFixedFrameName(object.id).size();
+        }
+    }));
+
+    // ObjectData runs loadState on construction: the direct SPICE path, without the batched tables
+    for (bool lightTimeAdjusted : { false, true }) {
+        rows.emplace_back(lightTimeAdjusted ? "loadState 'l'" : "loadState 'i'", bestNsPerOp(epochs.size() * objects.size(), [&] {
+            for (SpiceDouble et : epochs) {
+                for (const CatalogObject* object : objects) {
+                    ObjectData data(et, *object, options.observerId, lightTimeAdjusted);
+                    sizeSink = sizeSink + data.isAvailable();
+                }
+            }
+        }));
+    }
+
+    std::vector<ObjectData> states;
+    for (const CatalogObject* object : objects) states.emplace_back(epochs.front(), *object, options.observerId, false);
+    std::string buffer;
+    buffer.reserve(states.size() * OBJECT_DATA_SIZE);
+    rows.emplace_back("serializeToBinary", bestNsPerOp(timestamps.size() * states.size(), [&] {
+        for (size_t r = 0; r < timestamps.size(); r++) {
+            buffer.clear();
+            for (const ObjectData& data : states) data.serializeToBinary(buffer);
+            sizeSink = sizeSink + buffer.size();
+        }
+    }));
+
+    // RequestHandler end to end, through the same entry point as the compute thread and the workers,
+    // then with --metrics for the cost of the stage timers, then as a sampled request of --trace
+    bool metrics = serverOptions.metrics;
+    int traceSampling = serverOptions.traceSampling;
+    for (const char* variant : { "", " +metrics", " traced" }) {
+        serverOptions.metrics = std::strcmp(variant, " +metrics") == 0;
+        serverOptions.traceSampling = std::strcmp(variant, " traced") == 0 ? 1 : traceSampling;
+        setCurrentTrace(serverOptions.traceSampling == 1 ? sampleTrace() : 0);
+
+        for (MessageMode mode : { MessageMode::ALL_INSTANTANEOUS, MessageMode::ALL_LIGHT_TIME_ADJUSTED }) {
+            std::vector<std::string> requests;
+            for (size_t i = 0; i < epochs.size(); i++) requests.push_back(makeRequest(timestamps[i], mode, options.observerId));
+
+            std::string name = mode == MessageMode::ALL_INSTANTANEOUS ? "RequestHandler 'i'" : "RequestHandler 'l'";
+            std::string responseBuffer;
+            rows.emplace_back(name + variant, bestNsPerOp(requests.size(), [&] {
+                for (const auto& request : requests) sizeSink = sizeSink + processRequest(request, responseBuffer).size();
+            }));
+        }
+    }
+    setCurrentTrace(0);
+    serverOptions.metrics = metrics;
+    serverOptions.traceSampling = traceSampling;
+    invalidateLightTimeEngine();
+    invalidateBarycentricTable();
+
+    std::cout << "\nHot path (best of " << MICRO_REPETITIONS << ", " << objects.size() << " objects, observer "
+              << options.observerId << ")\n\n";
+    for (const auto& [name, ns] : rows) {
+        recordResult("micro", name, ns, "ns/op");
+        std::cout << std::setw(28) << name << std::setw(12) << std::fixed << std::setprecision(1) << ns << " ns/op\n";
+    }
+    std::cout << std::flush;
+}
+
+
+
+// ─────────────────────────────────────────────
+// Main - Entry Point
+// ─────────────────────────────────────────────
+
+int main(int argc, char* argv[]) {
+    if (isSpiceWorkerInvocation(argc, argv)) {
+        if (const char* fixtures = std::getenv(FIXTURE_ENVIRONMENT)) useBenchFixtures(fixtures);
+        return runSpiceWorker(argc, argv);
+    }
+
+    BenchOptions options;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string option = argv[i];
+        if (option == "--max-workers") options.maxWorkers = std::max(1, std::atoi(argv[i + 1]));
+        else if (option == "--requests") options.requests = std::max(1, std::atoi(argv[i + 1]));
+        else if (option == "--observer") options.observerId = std::atoi(argv[i + 1]);
+        else if (option == "--case") options.benchCase = argv[i + 1];
+        else if (option == "--fixtures") options.fixtures = argv[i + 1];
+        else if (option == "--json") options.jsonPath = argv[i + 1];
+        else {
+            std::cerr << "Usage: " << argv[0] << " [--max-workers <n>] [--requests <n>] [--observer <id>]"
+                      << " [--case workers|time|ssb|lt|encoding|alloc|multi|snapshot|micro|all]"
+                      << " [--fixtures <dir>] [--json <file>]\n";
+            return ERR_INVALID_ARGUMENTS;
+        }
+    }
+
+    // Synthetic kernels instead of the ESA download, also for the SPICE worker processes
+    if (!options.fixtures.empty()) {
+        if (!writeBenchFixtures(options.fixtures)) return ERR_INVALID_ARGUMENTS;
+        useBenchFixtures(options.fixtures);
+        setenv(FIXTURE_ENVIRONMENT, options.fixtures.c_str(), 1);
+    }
+
+    initSpiceCore();
+    bool pass = true;                                       // Every case that prints PASS or FAIL
+    if (options.benchCase == "all" || options.benchCase == "time") pass &= benchTimeConversion(options);
+    if (options.benchCase == "all" || options.benchCase == "micro") benchHotPath(options);
+    if (options.benchCase == "all" || options.benchCase == "ssb") pass &= benchBarycentricTable(options);
+    if (options.benchCase == "all" || options.benchCase == "lt") pass &= benchLightTimeEngine(options);
+    if (options.benchCase == "all" || options.benchCase == "encoding") benchResponseEncoding(options);
+    if (options.benchCase == "all" || options.benchCase == "alloc") pass &= benchRequestAllocations(options);
+    if (options.benchCase == "all" || options.benchCase == "multi") benchMultiRequests(options);
+    if (options.benchCase == "all" || options.benchCase == "snapshot") pass &= benchEphemerisSnapshot(options);
+    if (options.benchCase == "all" || options.benchCase == "workers") benchWorkerScaling(options);
+    deinitSpiceCore();
+
+    if (!options.jsonPath.empty() && !writeJsonResults(options)) {
+        std::cerr << "Cannot write " << options.jsonPath << "\n" << std::flush;
+        return ERR_INVALID_ARGUMENTS;
+    }
+
+    return pass ? SUCCESSFUL_EXIT : ERR_CHECK_FAILED;
+}
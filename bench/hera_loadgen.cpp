@@ -0,0 +1,841 @@
+/*
+ *  Copyright 2025 Mendel Dobondi-Reisz
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+// Standard C++ Libraries
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <cstring>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include <deque>
+#include <array>
+#include <cmath>
+
+// System Libraries
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/epoll.h>
+#include <netinet/tcp.h>
+#include <netinet/in.h>
+#include <unistd.h>
+#include <netdb.h>
+#include <fcntl.h>
+
+// Project Headers
+#include <server_threads.hpp>
+#include <spice_core.hpp>
+#include <utils.hpp>
+
+
+
+// ─────────────────────────────────────────────
+// Load Generator Options
+// ─────────────────────────────────────────────
+
+#define LOADGEN_CONNECT_BURST 64            // Handshakes in progress per thread while connections are opened
+#define LOADGEN_EVENTS 256                  // epoll events per wait
+#define LOADGEN_READ_SIZE 65536
+#define LOADGEN_SWEEP_INTERVAL 0.1          // Seconds between timeout sweeps
+
+using LoadClock = std::chrono::steady_clock;
+
+struct LoadOptions {
+    std::string host = "127.0.0.1";
+    std::string port = "8080";
+    int connections = 100;
+    int threads = static_cast<int>(std::thread::hardware_concurrency());
+    double duration = 10.0;                 // Seconds measured, after the warm-up
+    double warmup = 2.0;                    // Seconds whose responses are not measured
+    double rate = 0.0;                      // Requests/s over every connection, 0 runs closed-loop
+    int inflight = 1;                       // Closed-loop: requests outstanding per connection
+    std::vector<std::pair<MessageMode, double>> mix = { { MessageMode::ALL_INSTANTANEOUS, 1.0 } };
+    std::vector<int32_t> observers = { -91000 };    // HERA_SPACECRAFT
+    bool monotonic = true;                  // Per-connection playback, or random epochs within the span
+    double startTimestamp = 1798761600.0;   // 2027-01-01T00:00:00 UTC, inside the HERA operations window
+    double span = 30 * 86400.0;             // Random timestamps: seconds after the start
+    double step = 1.0 / 60.0;               // Monotonic timestamps: seconds between requests of a connection
+    double timeout = 5.0;                   // Seconds until an unanswered request counts as lost
+    std::string jsonPath;
+    int backpressureCheck = 0;              // Replies of a multi-request sent behind a full socket, 0 runs the load
+};
+
+static bool parseMix(const std::string& text, LoadOptions& options) {
+    options.mix.clear();
+    std::stringstream entries(text);
+    std::string entry;
+    while (std::getline(entries, entry, ',')) {
+        if (entry.empty() || (entry[0] != 'i' && entry[0] != 'l')) return false;
+        double weight = entry.size() > 2 && entry[1] == ':' ? std::atof(entry.c_str() + 2) : 1.0;
+        if (weight <= 0.0) return false;
+        options.mix.emplace_back(static_cast<MessageMode>(entry[0]), weight);
+    }
+    return !options.mix.empty();
+}
+
+static bool parseObservers(const std::string& text, LoadOptions& options) {
+    options.observers.clear();
+    std::stringstream entries(text);
+    std::string entry;
+    while (std::getline(entries, entry, ',')) {
+        if (!entry.empty()) options.observers.push_back(std::atoi(entry.c_str()));
+    }
+    return !options.observers.empty();
+}
+
+
+
+// ─────────────────────────────────────────────
+// Latency Histogram - log-linear buckets, ~1.6% resolution from 1 ns
+// ─────────────────────────────────────────────
+
+#define HISTOGRAM_SUB_BITS 6                // 64 linear buckets per power of two
+#define HISTOGRAM_SUB_BUCKETS (1 << HISTOGRAM_SUB_BITS)
+#define HISTOGRAM_BUCKETS ((64 - HISTOGRAM_SUB_BITS + 1) * HISTOGRAM_SUB_BUCKETS)
+
+class LatencyHistogram {
+public:
+    void record(uint64_t ns) {
+        counts[bucket(ns)]++;
+        total++;
+        maximum = std::max(maximum, ns);
+    }
+
+    void merge(const LatencyHistogram& other) {
+        for (size_t i = 0; i < counts.size(); i++) counts[i] += other.counts[i];
+        total += other.total;
+        maximum = std::max(maximum, other.maximum);
+    }
+
+    uint64_t percentile(double fraction) const {
+        if (!total) return 0;
+        uint64_t rank = static_cast<uint64_t>(std::ceil(fraction * total));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < counts.size(); i++) {
+            seen += counts[i];
+            if (seen >= rank) return std::min(upperBound(i), maximum);
+        }
+        return maximum;
+    }
+
+    uint64_t count() const { return total; }
+    uint64_t max() const { return maximum; }
+
+private:
+    std::array<uint64_t, HISTOGRAM_BUCKETS> counts{};
+    uint64_t total = 0;
+    uint64_t maximum = 0;
+
+    // Exact below 2 * 64 ns, then 64 buckets per power of two
+    static size_t bucket(uint64_t ns) {
+        if (ns < 2 * HISTOGRAM_SUB_BUCKETS) return ns;
+        int shift = 63 - __builtin_clzll(ns) - HISTOGRAM_SUB_BITS;
+        return (shift + 1) * HISTOGRAM_SUB_BUCKETS + ((ns >> shift) - HISTOGRAM_SUB_BUCKETS);
+    }
+
+    static uint64_t upperBound(size_t index) {
+        if (index < 2 * HISTOGRAM_SUB_BUCKETS) return index;
+        int shift = static_cast<int>(index / HISTOGRAM_SUB_BUCKETS) - 1;
+        uint64_t base = (index % HISTOGRAM_SUB_BUCKETS + HISTOGRAM_SUB_BUCKETS) << shift;
+        return base + ((uint64_t(1) << shift) - 1);
+    }
+};
+
+
+
+// ─────────────────────────────────────────────
+// WebSocket Client Connection - RFC 6455 over a non-blocking socket
+// ─────────────────────────────────────────────
+
+enum class ConnectionState { CONNECTING, HANDSHAKE, OPEN, CLOSED };
+
+struct OutstandingRequest {
+    double timestamp;                       // Echoed in the response header
+    LoadClock::time_point sentAt;           // Intended send time in open-loop runs
+};
+
+struct Connection {
+    int fd = -1;
+    ConnectionState state = ConnectionState::CONNECTING;
+    std::string input;                      // Received, not yet parsed
+    std::string output;                     // Not yet accepted by the socket
+    std::string message;                    // Fragments of the message being received
+    std::deque<OutstandingRequest> outstanding;
+    double nextTimestamp = 0.0;             // Monotonic playback position
+    bool writable = true;
+};
+
+struct LoadStats {
+    LatencyHistogram latency;
+    uint64_t opened = 0;
+    uint64_t failed = 0;
+    uint64_t closed = 0;
+    uint64_t sent = 0;
+    uint64_t responses = 0;                 // Measured, after the warm-up
+    uint64_t errors[3] = {};                // 'e', 'f', 'g'
+    uint64_t lost = 0;                      // No response within the timeout
+    uint64_t skipped = 0;                   // Open-loop sends without an open connection
+    uint64_t bytesIn = 0;
+    uint64_t bytesOut = 0;
+};
+
+// Client frames are always masked
+static void appendClientFrame(std::string& output, uint8_t opcode, const char* payload, size_t length, uint32_t mask) {
+    char header[14] = { static_cast<char>(0x80 | opcode) };
+    size_t headerLength = 2;
+    if (length < 126) header[1] = static_cast<char>(0x80 | length);
+    else {
+        header[1] = static_cast<char>(0x80 | 126);
+        header[2] = static_cast<char>(length >> 8);
+        header[3] = static_cast<char>(length);
+        headerLength = 4;
+    }
+
+    std::memcpy(header + headerLength, &mask, sizeof(mask));
+    headerLength += sizeof(mask);
+
+    output.append(header, headerLength);
+    const char* maskBytes = reinterpret_cast<const char*>(&mask);
+    for (size_t i = 0; i < length; i++) output.push_back(payload[i] ^ maskBytes[i % 4]);
+}
+
+static std::string handshakeRequest(const LoadOptions& options) {
+    return "GET " ENTRY_POINT " HTTP/1.1\r\nHost: " + options.host + ":" + options.port +
+           "\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+           "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\nSec-WebSocket-Version: 13\r\n\r\n";
+}
+
+class LoadThread {
+public:
+    LoadThread(const LoadOptions& options, int connectionCount, uint32_t seed)
+        : options(options), connections(connectionCount), random(seed ? seed : 1) {}
+
+    void run(LoadClock::time_point measureStart, LoadClock::time_point measureEnd, double threadRate);
+    const LoadStats& stats() const { return result; }
+
+private:
+    const LoadOptions& options;
+    std::vector<Connection> connections;
+    LoadStats result;
+    uint32_t random;
+    int epollFd = -1;
+    addrinfo* address = nullptr;
+    LoadClock::time_point measureStart;
+
+    uint32_t nextRandom() {                 // xorshift32: masks, modes, observers and random epochs
+        random ^= random << 13;
+        random ^= random >> 17;
+        random ^= random << 5;
+        return random;
+    }
+
+    bool startConnect(Connection& connection);
+    void closeConnection(Connection& connection, bool failed);
+    void flush(Connection& connection);
+    void sendFrame(Connection& connection, uint8_t opcode, const char* payload, size_t length);
+    void sendRequest(Connection& connection, LoadClock::time_point sentAt);
+    void onReadable(Connection& connection, LoadClock::time_point now);
+    bool parseHandshake(Connection& connection);
+    void parseFrames(Connection& connection, LoadClock::time_point now);
+    void onResponse(Connection& connection, std::string_view response, LoadClock::time_point now);
+    void sweepTimeouts(LoadClock::time_point now);
+};
+
+bool LoadThread::startConnect(Connection& connection) {
+    connection = Connection{};
+    connection.nextTimestamp = options.startTimestamp;
+    connection.fd = socket(address->ai_family, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    if (connection.fd < 0) return false;
+
+    int one = 1;
+    setsockopt(connection.fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    if (connect(connection.fd, address->ai_addr, address->ai_addrlen) < 0 && errno != EINPROGRESS) {
+        close(connection.fd);
+        connection.fd = -1;
+        return false;
+    }
+
+    epoll_event event{};
+    event.events = EPOLLIN | EPOLLOUT | EPOLLET;
+    event.data.ptr = &connection;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, connection.fd, &event);
+    return true;
+}
+
+void LoadThread::closeConnection(Connection& connection, bool failed) {
+    if (connection.state == ConnectionState::CLOSED) return;
+    if (failed && connection.state != ConnectionState::OPEN) result.failed++;
+    else result.closed++;
+    if (connection.fd >= 0) close(connection.fd);
+    connection.fd = -1;
+    connection.state = ConnectionState::CLOSED;
+    connection.outstanding.clear();
+}
+
+void LoadThread::flush(Connection& connection) {
+    while (!connection.output.empty() && connection.writable) {
+        ssize_t written = send(connection.fd, connection.output.data(), connection.output.size(), MSG_NOSIGNAL);
+        if (written > 0) {
+            result.bytesOut += written;
+            connection.output.erase(0, written);
+        }
+        else if (written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) connection.writable = false;
+        else {
+            closeConnection(connection, true);
+            return;
+        }
+    }
+}
+
+void LoadThread::sendFrame(Connection& connection, uint8_t opcode, const char* payload, size_t length) {
+    appendClientFrame(connection.output, opcode, payload, length, nextRandom());
+    flush(connection);
+}
+
+void LoadThread::sendRequest(Connection& connection, LoadClock::time_point sentAt) {
+    double total = 0.0;
+    for (const auto& [mode, weight] : options.mix) total += weight;
+    double pick = total * nextRandom() / 4294967296.0;
+    MessageMode mode = options.mix.back().first;
+    for (const auto& [candidate, weight] : options.mix) {
+        if (pick < weight) { mode = candidate; break; }
+        pick -= weight;
+    }
+
+    int32_t observerId = options.observers[nextRandom() % options.observers.size()];
+    double timestamp = options.startTimestamp + options.span * (nextRandom() / 4294967296.0);
+    if (options.monotonic) {
+        timestamp = connection.nextTimestamp;
+        connection.nextTimestamp += options.step;
+    }
+
+    char request[EXPECTED_MESSAGE_LENGTH];
+    std::memcpy(request, &timestamp, sizeof(timestamp));
+    request[sizeof(timestamp)] = static_cast<char>(mode);
+    std::memcpy(request + sizeof(timestamp) + 1, &observerId, sizeof(observerId));
+
+    connection.outstanding.push_back({ timestamp, sentAt });
+    result.sent++;
+    sendFrame(connection, 0x2, request, sizeof(request));
+}
+
+bool LoadThread::parseHandshake(Connection& connection) {
+    size_t end = connection.input.find("\r\n\r\n");
+    if (end == std::string::npos) return true;                  // Not complete yet
+
+    if (connection.input.compare(0, 12, "HTTP/1.1 101") != 0) return false;
+    connection.input.erase(0, end + 4);
+    connection.state = ConnectionState::OPEN;
+    result.opened++;
+    return true;
+}
+
+void LoadThread::onResponse(Connection& connection, std::string_view response, LoadClock::time_point now) {
+    if (response.size() < sizeof(double) + 1 || connection.outstanding.empty()) return;
+
+    // The echoed timestamp names the request, the oldest one if the server snapped it
+    double timestamp;
+    std::memcpy(&timestamp, response.data(), sizeof(timestamp));
+    auto it = std::find_if(connection.outstanding.begin(), connection.outstanding.end(),
+                           [&](const OutstandingRequest& request) { return request.timestamp == timestamp; });
+    if (it == connection.outstanding.end()) it = connection.outstanding.begin();
+
+    if (it->sentAt >= measureStart) {
+        char mode = response[sizeof(double)] & ~MESSAGE_FLAG_TDB;
+        if (mode == 'e' || mode == 'f' || mode == 'g') result.errors[mode - 'e']++;
+        result.responses++;
+        result.latency.record(std::chrono::duration_cast<std::chrono::nanoseconds>(now - it->sentAt).count());
+    }
+    connection.outstanding.erase(it);
+
+    if (options.rate <= 0.0) sendRequest(connection, now);      // Closed loop: the next one right away
+}
+
+void LoadThread::parseFrames(Connection& connection, LoadClock::time_point now) {
+    size_t offset = 0;
+    std::string& input = connection.input;
+
+    while (input.size() - offset >= 2) {
+        uint8_t first = input[offset], second = input[offset + 1];
+        uint64_t length = second & 0x7F;
+        size_t headerLength = 2;
+        if (length == 126) {
+            if (input.size() - offset < 4) break;
+            length = (uint8_t(input[offset + 2]) << 8) | uint8_t(input[offset + 3]);
+            headerLength = 4;
+        }
+        else if (length == 127) {
+            if (input.size() - offset < 10) break;
+            length = 0;
+            for (int i = 0; i < 8; i++) length = (length << 8) | uint8_t(input[offset + 2 + i]);
+            headerLength = 10;
+        }
+        if (input.size() - offset < headerLength + length) break;
+
+        std::string_view payload(input.data() + offset + headerLength, length);
+        offset += headerLength + length;
+
+        uint8_t opcode = first & 0x0F;
+        if (opcode == 0x8) {                                    // Close
+            closeConnection(connection, false);
+            return;
+        }
+        if (opcode == 0x9) {                                    // Ping
+            sendFrame(connection, 0xA, payload.data(), payload.size());
+            continue;
+        }
+        if (opcode == 0xA) continue;                            // Pong
+
+        connection.message.append(payload);
+        if (!(first & 0x80)) continue;                          // More fragments follow
+        onResponse(connection, connection.message, now);
+        connection.message.clear();
+        if (connection.state == ConnectionState::CLOSED) return;
+    }
+    input.erase(0, offset);
+}
+
+void LoadThread::onReadable(Connection& connection, LoadClock::time_point now) {
+    char buffer[LOADGEN_READ_SIZE];
+    while (connection.state != ConnectionState::CLOSED) {
+        ssize_t received = recv(connection.fd, buffer, sizeof(buffer), 0);
+        if (received > 0) {
+            result.bytesIn += received;
+            connection.input.append(buffer, received);
+            continue;
+        }
+        if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        closeConnection(connection, true);
+        return;
+    }
+
+    if (connection.state == ConnectionState::HANDSHAKE) {
+        if (!parseHandshake(connection)) {
+            closeConnection(connection, true);
+            return;
+        }
+        if (connection.state == ConnectionState::OPEN && options.rate <= 0.0) {
+            for (int i = 0; i < options.inflight; i++) sendRequest(connection, now);
+        }
+    }
+    if (connection.state == ConnectionState::OPEN) parseFrames(connection, now);
+}
+
+void LoadThread::sweepTimeouts(LoadClock::time_point now) {
+    auto timeout = std::chrono::duration_cast<LoadClock::duration>(std::chrono::duration<double>(options.timeout));
+    for (Connection& connection : connections) {
+        if (connection.state != ConnectionState::OPEN) continue;
+        size_t expired = 0;
+        while (!connection.outstanding.empty() && now - connection.outstanding.front().sentAt > timeout) {
+            if (connection.outstanding.front().sentAt >= measureStart) result.lost++;
+            connection.outstanding.pop_front();
+            expired++;
+        }
+        // Dropped by the server's backpressure: closed-loop connections would stall without a replacement
+        if (options.rate <= 0.0) {
+            for (size_t i = 0; i < expired; i++) sendRequest(connection, now);
+        }
+    }
+}
+
+void LoadThread::run(LoadClock::time_point start, LoadClock::time_point end, double threadRate) {
+    measureStart = start;
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    if (getaddrinfo(options.host.c_str(), options.port.c_str(), &hints, &address) != 0 || !address) {
+        result.failed = connections.size();
+        return;
+    }
+    epollFd = epoll_create1(0);
+
+    const std::string handshake = handshakeRequest(options);
+
+    size_t nextConnect = 0, roundRobin = 0;
+    auto interval = std::chrono::duration_cast<LoadClock::duration>(
+        std::chrono::duration<double>(threadRate > 0.0 ? 1.0 / threadRate : 0.0));
+    auto nextSend = LoadClock::now();
+    auto nextSweep = nextSend;
+    epoll_event events[LOADGEN_EVENTS];
+
+    while (LoadClock::now() < end) {
+        // Open connections in bursts, so the server's accept backlog does not overflow
+        if (nextConnect < connections.size()) {
+            size_t pending = 0;
+            for (size_t i = 0; i < nextConnect; i++) {
+                pending += connections[i].state == ConnectionState::CONNECTING || connections[i].state == ConnectionState::HANDSHAKE;
+            }
+            while (nextConnect < connections.size() && pending < LOADGEN_CONNECT_BURST) {
+                if (startConnect(connections[nextConnect])) pending++;
+                else {
+                    connections[nextConnect].state = ConnectionState::CLOSED;
+                    result.failed++;
+                }
+                nextConnect++;
+            }
+        }
+
+        // Open loop: every due request is sent, latency counts from when it was due
+        auto now = LoadClock::now();
+        while (threadRate > 0.0 && now >= nextSend) {
+            Connection* target = nullptr;
+            for (size_t i = 0; i < connections.size() && !target; i++) {
+                Connection& candidate = connections[(roundRobin + i) % connections.size()];
+                if (candidate.state == ConnectionState::OPEN) target = &candidate;
+            }
+            roundRobin++;
+            if (target) sendRequest(*target, nextSend);
+            else if (nextSend >= measureStart) result.skipped++;
+            nextSend += interval;
+        }
+
+        int timeoutMs = 1;
+        if (threadRate > 0.0 && nextSend > now) {
+            timeoutMs = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(nextSend - now).count());
+        }
+        int count = epoll_wait(epollFd, events, LOADGEN_EVENTS, std::min(timeoutMs, 10));
+        now = LoadClock::now();
+
+        for (int i = 0; i < count; i++) {
+            Connection& connection = *static_cast<Connection*>(events[i].data.ptr);
+            if (connection.state == ConnectionState::CLOSED) continue;
+            if (events[i].events & (EPOLLERR | EPOLLHUP) && connection.state == ConnectionState::CONNECTING) {
+                closeConnection(connection, true);
+                continue;
+            }
+            if (events[i].events & EPOLLOUT) {
+                connection.writable = true;
+                if (connection.state == ConnectionState::CONNECTING) {
+                    connection.state = ConnectionState::HANDSHAKE;
+                    connection.output = handshake;
+                }
+                flush(connection);
+            }
+            if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) onReadable(connection, now);
+        }
+
+        if (now >= nextSweep) {
+            sweepTimeouts(now);
+            nextSweep = now + std::chrono::duration_cast<LoadClock::duration>(std::chrono::duration<double>(LOADGEN_SWEEP_INTERVAL));
+        }
+    }
+
+    for (Connection& connection : connections) {
+        if (connection.state != ConnectionState::CLOSED && connection.fd >= 0) close(connection.fd);
+    }
+    close(epollFd);
+    freeaddrinfo(address);
+}
+
+
+
+// ─────────────────────────────────────────────
+// Backpressure Check - a multi-request behind a full socket
+// ─────────────────────────────────────────────
+
+#define LOADGEN_CHECK_RANGES 4              // Range requests whose frames fill the server's send buffer
+#define LOADGEN_CHECK_RANGE_SAMPLES 1024
+#define LOADGEN_CHECK_WINDOW 4096           // Client receive buffer, keeps the range frames in the server
+#define LOADGEN_CHECK_SETTLE 1.0            // Seconds for the range frames to be computed and queued
+
+static bool sendAll(int fd, const std::string& data) {
+    for (size_t offset = 0; offset < data.size();) {
+        ssize_t written = send(fd, data.data() + offset, data.size() - offset, MSG_NOSIGNAL);
+        if (written <= 0) return false;
+        offset += written;
+    }
+    return true;
+}
+
+static bool receiveExact(int fd, char* data, size_t length) {
+    while (length) {
+        ssize_t received = recv(fd, data, length, 0);
+        if (received <= 0) return false;
+        data += received;
+        length -= received;
+    }
+    return true;
+}
+
+// Next data message, control frames are skipped. False on close or after the receive timeout.
+static bool receiveMessage(int fd, std::string& message) {
+    message.clear();
+    while (true) {
+        unsigned char header[2];
+        if (!receiveExact(fd, reinterpret_cast<char*>(header), sizeof(header))) return false;
+        uint64_t length = header[1] & 0x7F;
+        if (length >= 126) {
+            unsigned char extended[8];
+            size_t size = length == 126 ? 2 : 8;
+            if (!receiveExact(fd, reinterpret_cast<char*>(extended), size)) return false;
+            length = 0;
+            for (size_t i = 0; i < size; i++) length = (length << 8) | extended[i];
+        }
+
+        size_t offset = message.size();
+        message.resize(offset + length);
+        if (!receiveExact(fd, message.data() + offset, length)) return false;
+
+        uint8_t opcode = header[0] & 0x0F;
+        if (opcode == 0x8) return false;                        // Close
+        if (opcode & 0x8) {                                     // Ping, pong
+            message.resize(offset);
+            continue;
+        }
+        if (header[0] & 0x80) return true;
+    }
+}
+
+/*
+ * Fills the server's send buffer for one connection past --max-buffered with range frames the client
+ * does not read, then sends a multi-request of 'replies' 'i' requests. Every one of them must be
+ * answered once the client reads again: multi-request replies are never held back like real-time frames.
+ */
+static int runBackpressureCheck(const LoadOptions& options) {
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* address = nullptr;
+    if (getaddrinfo(options.host.c_str(), options.port.c_str(), &hints, &address) != 0 || !address) return ERR_SOCKET_NULL;
+
+    int fd = socket(address->ai_family, SOCK_STREAM, 0);
+    if (fd < 0) {
+        freeaddrinfo(address);
+        return ERR_SOCKET_NULL;
+    }
+    int window = LOADGEN_CHECK_WINDOW;
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &window, sizeof(window));    // Before connect: the advertised window
+    timeval timeout{};
+    timeout.tv_sec = static_cast<time_t>(options.timeout);
+    timeout.tv_usec = static_cast<suseconds_t>((options.timeout - timeout.tv_sec) * 1e6);
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    bool connected = connect(fd, address->ai_addr, address->ai_addrlen) == 0;
+    freeaddrinfo(address);
+
+    // The server sends nothing after the upgrade response until the first request
+    std::string handshake;
+    char byte;
+    if (connected && sendAll(fd, handshakeRequest(options))) {
+        while (handshake.find("\r\n\r\n") == std::string::npos && receiveExact(fd, &byte, 1)) handshake.push_back(byte);
+    }
+    if (handshake.compare(0, 12, "HTTP/1.1 101") != 0) {
+        std::cerr << "Cannot open a WebSocket to " << options.host << ":" << options.port << "\n" << std::flush;
+        close(fd);
+        return ERR_SOCKET_NULL;
+    }
+
+    int32_t observerId = options.observers.front();
+    uint32_t mask = 2654435761u;
+    std::string output;
+    for (int r = 0; r < LOADGEN_CHECK_RANGES; r++) {
+        double start = options.startTimestamp - (r + 1) * 86400.0, end = start + 86400.0;
+        double step = -LOADGEN_CHECK_RANGE_SAMPLES;             // Negative: a sample count
+        char request[EXPECTED_RANGE_MESSAGE_LENGTH];
+        std::memcpy(request, &start, sizeof(start));
+        request[sizeof(start)] = static_cast<char>(MessageMode::RANGE_INSTANTANEOUS);
+        std::memcpy(request + sizeof(start) + 1, &observerId, sizeof(observerId));
+        std::memcpy(request + EXPECTED_MESSAGE_LENGTH, &end, sizeof(end));
+        std::memcpy(request + EXPECTED_MESSAGE_LENGTH + sizeof(end), &step, sizeof(step));
+        appendClientFrame(output, 0x2, request, sizeof(request), mask);
+    }
+    bool sent = sendAll(fd, output);
+    std::this_thread::sleep_for(std::chrono::duration<double>(LOADGEN_CHECK_SETTLE));
+
+    // Distinct timestamps, so every reply names its request
+    int replies = std::min(options.backpressureCheck, MULTI_REQUEST_MAX);
+    std::vector<double> timestamps;
+    std::string multi = { MULTI_REQUEST_COMMAND, static_cast<char>(replies) };
+    for (int k = 0; k < replies; k++) {
+        double timestamp = options.startTimestamp + k * 60.0;
+        char request[EXPECTED_MESSAGE_LENGTH];
+        std::memcpy(request, &timestamp, sizeof(timestamp));
+        request[sizeof(timestamp)] = static_cast<char>(MessageMode::ALL_INSTANTANEOUS);
+        std::memcpy(request + sizeof(timestamp) + 1, &observerId, sizeof(observerId));
+        multi.append(request, sizeof(request));
+        timestamps.push_back(timestamp);
+    }
+    output.clear();
+    appendClientFrame(output, 0x2, multi.data(), multi.size(), mask);
+    sent = sent && sendAll(fd, output);
+
+    // Read again: the range frames first, then every reply
+    int answered = 0, ranges = 0;
+    std::string message;
+    while (sent && answered < replies && receiveMessage(fd, message)) {
+        if (message.size() < sizeof(double) + 1) continue;
+        double timestamp;
+        std::memcpy(&timestamp, message.data(), sizeof(timestamp));
+        auto it = std::find(timestamps.begin(), timestamps.end(), timestamp);
+        if (it != timestamps.end()) {
+            timestamps.erase(it);
+            answered++;
+        }
+        else ranges++;
+    }
+    close(fd);
+
+    bool pass = answered == replies;
+    std::cout << "\nhera_loadgen backpressure check (" << LOADGEN_CHECK_RANGES << " range frames of "
+              << LOADGEN_CHECK_RANGE_SAMPLES << " samples ahead)\n\n";
+    std::cout << std::setw(24) << "range frames read" << std::setw(12) << ranges << "\n";
+    std::cout << std::setw(24) << "multi-request replies" << std::setw(12) << answered << " / " << replies << "\n";
+    std::cout << std::setw(24) << "result" << std::setw(12) << (pass ? "PASS" : "FAIL") << "\n" << std::flush;
+    return pass ? SUCCESSFUL_EXIT : ERR_CHECK_FAILED;
+}
+
+
+
+// ─────────────────────────────────────────────
+// Report
+// ─────────────────────────────────────────────
+
+static void printReport(const LoadOptions& options, const LoadStats& stats) {
+    double throughput = stats.responses / options.duration;
+    auto ms = [](uint64_t ns) { return ns / 1e6; };
+
+    std::cout << "\nhera_loadgen (" << options.connections << " connections, " << options.threads << " threads, "
+              << (options.rate > 0.0 ? "open loop at " + std::to_string(static_cast<long>(options.rate)) + " req/s"
+                                     : "closed loop, " + std::to_string(options.inflight) + " in flight")
+              << ", " << (options.monotonic ? "monotonic" : "random") << " timestamps)\n\n";
+    std::cout << std::setw(24) << "connections open" << std::setw(12) << stats.opened << " (" << stats.failed << " failed, "
+              << stats.closed << " closed by the server)\n";
+    std::cout << std::setw(24) << "requests sent" << std::setw(12) << stats.sent << "\n";
+    std::cout << std::setw(24) << "responses measured" << std::setw(12) << stats.responses << " in "
+              << std::fixed << std::setprecision(1) << options.duration << " s\n";
+    std::cout << std::setw(24) << "errors e / f / g" << std::setw(12) << stats.errors[0] << " / " << stats.errors[1]
+              << " / " << stats.errors[2] << "\n";
+    std::cout << std::setw(24) << "lost / skipped" << std::setw(12) << stats.lost << " / " << stats.skipped << "\n";
+    std::cout << std::setw(24) << "throughput" << std::setw(12) << std::setprecision(0) << throughput << " responses/s\n";
+    std::cout << std::setw(24) << "bytes in / out" << std::setw(12) << stats.bytesIn << " / " << stats.bytesOut << "\n";
+    std::cout << std::setw(24) << "latency p50" << std::setw(12) << std::setprecision(3) << ms(stats.latency.percentile(0.50)) << " ms\n";
+    std::cout << std::setw(24) << "latency p99" << std::setw(12) << ms(stats.latency.percentile(0.99)) << " ms\n";
+    std::cout << std::setw(24) << "latency p999" << std::setw(12) << ms(stats.latency.percentile(0.999)) << " ms\n";
+    std::cout << std::setw(24) << "latency max" << std::setw(12) << ms(stats.latency.max()) << " ms\n" << std::flush;
+
+    if (options.jsonPath.empty()) return;
+
+    // Same layout as hera_bench --json
+    std::ofstream file(options.jsonPath, std::ios::trunc);
+    auto entry = [&](const char* metric, double value, const char* unit, bool last = false) {
+        file << "\n    { \"case\": \"loadgen\", \"metric\": \"" << metric << "\", \"value\": " << std::setprecision(17)
+             << value << ", \"unit\": \"" << unit << "\" }" << (last ? "" : ",");
+    };
+    file << "{\n  \"connections\": " << options.connections << ",\n  \"rate\": " << options.rate
+         << ",\n  \"inflight\": " << options.inflight << ",\n  \"results\": [";
+    entry("throughput", throughput, "responses/s");
+    entry("p50", ms(stats.latency.percentile(0.50)), "ms");
+    entry("p99", ms(stats.latency.percentile(0.99)), "ms");
+    entry("p999", ms(stats.latency.percentile(0.999)), "ms");
+    entry("max", ms(stats.latency.max()), "ms");
+    entry("errors", stats.errors[0] + stats.errors[1] + stats.errors[2], "responses");
+    entry("lost", stats.lost, "requests", true);
+    file << "\n  ]\n}\n";
+    if (!file) std::cerr << "Cannot write " << options.jsonPath << "\n" << std::flush;
+}
+
+
+
+// ─────────────────────────────────────────────
+// Main - Entry Point
+// ─────────────────────────────────────────────
+
+int main(int argc, char* argv[]) {
+    LoadOptions options;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string option = argv[i];
+        std::string value = argv[i + 1];
+        bool valid = true;
+        if (option == "--host") options.host = value;
+        else if (option == "--port") options.port = value;
+        else if (option == "--connections") options.connections = std::max(1, std::atoi(value.c_str()));
+        else if (option == "--threads") options.threads = std::max(1, std::atoi(value.c_str()));
+        else if (option == "--duration") options.duration = std::max(1.0, std::atof(value.c_str()));
+        else if (option == "--warmup") options.warmup = std::max(0.0, std::atof(value.c_str()));
+        else if (option == "--rate") options.rate = std::max(0.0, std::atof(value.c_str()));
+        else if (option == "--inflight") options.inflight = std::max(1, std::atoi(value.c_str()));
+        else if (option == "--mix") valid = parseMix(value, options);
+        else if (option == "--observers") valid = parseObservers(value, options);
+        else if (option == "--timestamps") options.monotonic = value != "random";
+        else if (option == "--start") options.startTimestamp = std::atof(value.c_str());
+        else if (option == "--span") options.span = std::max(0.0, std::atof(value.c_str()));
+        else if (option == "--step") options.step = std::atof(value.c_str());
+        else if (option == "--timeout") options.timeout = std::max(0.1, std::atof(value.c_str()));
+        else if (option == "--json") options.jsonPath = value;
+        else if (option == "--backpressure-check") options.backpressureCheck = std::max(1, std::atoi(value.c_str()));
+        else valid = false;
+
+        if (!valid) {
+            std::cerr << "Usage: " << argv[0] << " [--host <addr>] [--port <port>] [--connections <n>] [--threads <n>]"
+                      << " [--duration <s>] [--warmup <s>] [--rate <req/s> | --inflight <n>] [--mix i:<w>,l:<w>]"
+                      << " [--observers <id,...>] [--timestamps monotonic|random] [--start <unix>] [--span <s>]"
+                      << " [--step <s>] [--timeout <s>] [--json <file>] [--backpressure-check <replies>]\n";
+            return ERR_INVALID_ARGUMENTS;
+        }
+    }
+    if (options.backpressureCheck) return runBackpressureCheck(options);
+    options.threads = std::max(1, std::min(options.threads, options.connections));
+
+    // Thousands of sockets need more than the usual 1024 descriptors
+    rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+
+    std::vector<std::unique_ptr<LoadThread>> loadThreads;
+    for (int t = 0; t < options.threads; t++) {
+        int share = options.connections / options.threads + (t < options.connections % options.threads);
+        loadThreads.push_back(std::make_unique<LoadThread>(options, share, 2654435761u * (t + 1)));
+    }
+
+    auto measureStart = LoadClock::now() + std::chrono::duration_cast<LoadClock::duration>(std::chrono::duration<double>(options.warmup));
+    auto measureEnd = measureStart + std::chrono::duration_cast<LoadClock::duration>(std::chrono::duration<double>(options.duration));
+
+    std::vector<std::thread> threads;
+    for (auto& loadThread : loadThreads) {
+        threads.emplace_back([&, thread = loadThread.get()] {
+            thread->run(measureStart, measureEnd, options.rate / options.threads);
+        });
+    }
+    for (auto& thread : threads) thread.join();
+
+    LoadStats total;
+    for (const auto& loadThread : loadThreads) {
+        const LoadStats& stats = loadThread->stats();
+        total.latency.merge(stats.latency);
+        total.opened += stats.opened;
+        total.failed += stats.failed;
+        total.closed += stats.closed;
+        total.sent += stats.sent;
+        total.responses += stats.responses;
+        for (int i = 0; i < 3; i++) total.errors[i] += stats.errors[i];
+        total.lost += stats.lost;
+        total.skipped += stats.skipped;
+        total.bytesIn += stats.bytesIn;
+        total.bytesOut += stats.bytesOut;
+    }
+
+    printReport(options, total);
+    return total.opened ? SUCCESSFUL_EXIT : ERR_SOCKET_NULL;
+}
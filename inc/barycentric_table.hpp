@@ -0,0 +1,68 @@
+/*
+ *  Copyright 2025 Mendel Dobondi-Reisz
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef BARYCENTRIC_TABLE_HPP
+#define BARYCENTRIC_TABLE_HPP
+
+// Standard C++ Libraries
+#include <cstdint>
+#include <vector>
+
+// External Libraries
+#include <cspice/SpiceUsr.h>
+
+// Project Headers
+#include <object_catalog.hpp>
+
+// ─────────────────────────────────────────────
+// Barycentric Table - SSB states of one epoch
+// ─────────────────────────────────────────────
+struct BarycentricState {
+    SpiceDouble state[6];                       // Geometric J2000 state relative to the SSB, km and km/s
+    bool available;
+};
+
+/*
+ * Every selected catalog body is looked up relative to the SSB once per epoch,
+ * observer-relative geometric states are then a vector difference. Consecutive
+ * requests for the same epoch (other observers, other objects) reuse the table.
+ * Only touched while SPICE is held: the compute thread or a worker process.
+ */
+class BarycentricTable {
+public:
+    void prepare(SpiceDouble et, uint64_t objectMask);  // Fills the missing bodies of the epoch, resets on a new epoch
+    bool relativeState(const CatalogObject& object, SpiceInt observerId, SpiceDouble state[6]);
+    const BarycentricState* objectState(const CatalogObject& object) const;    // nullptr if not prepared
+    const BarycentricState& observerState(SpiceInt observerId);
+    SpiceDouble epoch() const;
+    void invalidate();                                  // Called whenever a kernel version is (re)loaded
+private:
+    SpiceDouble et = 0.0;
+    bool valid = false;
+    uint64_t loadedMask = 0;                            // Catalog indices already looked up for this epoch
+    std::vector<BarycentricState> objects;              // Indexed by CatalogObject::index
+    std::vector<std::pair<SpiceInt, BarycentricState>> observers;
+};
+
+bool barycentricState(SpiceInt id, SpiceDouble et, SpiceDouble state[6]);  // spkssb_c, the SSB itself included
+
+// ─────────────────────────────────────────────
+// Barycentric Table Instance
+// ─────────────────────────────────────────────
+extern BarycentricTable barycentricTable;
+void invalidateBarycentricTable();
+
+#endif // BARYCENTRIC_TABLE_HPP
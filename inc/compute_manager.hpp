@@ -0,0 +1,99 @@
+/*
+ *  Copyright 2025 Mendel Dobondi-Reisz
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef COMPUTE_MANAGER_HPP
+#define COMPUTE_MANAGER_HPP
+
+// Standard C++ Libraries
+#include <condition_variable>
+#include <unordered_map>
+#include <cstdint>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <deque>
+
+// External Libraries
+#include <uWebSockets/App.h>
+
+// Project Headers
+#include <websocket_manager.hpp>
+
+// ─────────────────────────────────────────────
+// Compute Task - request handed over by the event loop
+// ─────────────────────────────────────────────
+struct ComputeTask {
+    WS* ws;                 // Socket the response is addressed to
+    uint64_t session;       // Session of the socket when the request arrived
+    uWS::Loop* loop;        // Event loop owning the socket
+    uWS::OpCode opCode;     // Opcode the response is sent with
+    std::string request;    // Raw request bytes (copied out of the uWS receive buffer)
+    uint64_t cacheGeneration;   // Response cache generation when the request arrived
+    uint64_t subscription = 0;  // Serial of the subscription the frame belongs to, 0 for client requests
+    bool prefetch = false;      // Computed ahead of the client, kept in its prefetch stream
+    bool shared = false;        // Also answers identical requests that arrived while it was queued or computed
+    uint64_t queuedAt = 0;      // steadyNanoseconds() when it was submitted, 0 unless timed or traced
+    uint64_t trace = 0;         // Sampled trace id of the client request, 0 if it is not traced
+};
+
+// ─────────────────────────────────────────────
+// Compute Queue - event loop -> compute thread
+// ─────────────────────────────────────────────
+extern std::mutex computeMutex;
+extern std::condition_variable computeCondition;
+extern std::deque<ComputeTask> computeQueue;
+extern std::deque<ComputeTask> prefetchQueue;       // Runs only while computeQueue is empty
+void submitComputeTask(ComputeTask&& task);         // Called from the event loop, never blocks on SPICE: identical requests in flight are joined
+bool submitPrefetchTask(ComputeTask&& task);        // false while client requests wait for the backend or the prefetch queue is full
+bool waitForComputeTask(ComputeTask& task);         // Called from the compute thread: false on shutdown
+void takeComputeTasks(std::deque<ComputeTask>& backlog);   // Moves every queued task, never blocks
+bool takePrefetchTask(ComputeTask& task);           // One prefetch task for an idle worker, never blocks
+void publishWorkerBacklog(size_t waiting);          // Dispatcher: client requests no worker has started on
+
+// ─────────────────────────────────────────────
+// Single-Flight Coalescing - identical requests share one computation
+// ─────────────────────────────────────────────
+struct InFlightRequest {
+    uint64_t generation;                    // Response cache generation of the request that computes
+    std::vector<ComputeTask> followers;     // Answered from the same response
+};
+
+struct CoalescingStats {
+    uint64_t requests;                      // Requests handed to the compute backend
+    uint64_t coalesced;                     // Of those, answered from an identical request's computation
+};
+
+extern std::unordered_map<std::string, InFlightRequest> inFlightRequests;    // Guarded by computeMutex
+CoalescingStats coalescingStats();
+
+// ─────────────────────────────────────────────
+// Response Delivery - compute thread -> event loop
+// ─────────────────────────────────────────────
+
+/*
+ * Posts the response back to the loop that owns the socket, and to those of every coalesced request.
+ * The response is dropped for sockets that were closed in the meantime.
+ */
+void deliverResponse(const ComputeTask& task, std::string&& response);
+
+// ─────────────────────────────────────────────
+// ComputeManager Shutdown Control
+// ─────────────────────────────────────────────
+extern std::atomic<bool> shouldComputeManagerRun;
+void stopComputeManagerWorker();
+
+#endif // COMPUTE_MANAGER_HPP
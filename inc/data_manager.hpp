@@ -80,6 +80,8 @@ private:
     std::filesystem::path dataDirectory;                // Data directory (where the zip file - HERA.zip - is downloaded
     std::filesystem::path heraDirectory;                // Main Hera directory (data is used from here)
     std::filesystem::path kernelDirectory;              // Active kernel directory (referenced in meta-kernel files)
+    std::filesystem::path retiredHeraDirectory;         // Previous version, deleted once nothing has it loaded
+    bool retiredFromPlainDirectory = false;             // The previous version was data/hera itself, not a link target
 
     std::filesystem::path temporaryDirectory;           // Temporary directory
     std::filesystem::path temporaryHeraDirectory;       // Temporary directory for unzipping (HERA)
@@ -103,12 +105,21 @@ public:
     bool unzipZipFile();                                // Unzip the downloaded zip file
     bool editTempMetaKernelFiles();                     // Edit the temporary meta-kernel files ('..' -> 'actual/kernel/path') 
     bool editTempVersionFile();                         // Edit the temporary version file (update the version file in the new directory)
-    bool moveFolder();                                  // Move the unzipped folder to the data directory
+    bool moveFolder();                                  // Move the unzipped folder to data/hera.<version> and point data/hera at it
     bool deleteTmpFolder();                             // Delete the temporary folder
     bool deleteUnUsedFiles();                           // Delete unneeded files (manifest, readme, etc.) from the temporary directory
 
+    bool restorePreviousVersion();                      // Point data/hera back at the previous version after a failed swap
+    bool deleteRetiredVersion();                        // Delete the previous version once it is unloaded
+
     void makeSpiceDataAvailable();
     void makeSpiceDataUnavailable();
+    bool swapSpiceData();                               // Replace the loaded kernels with the ones on disk while serving
+    void makeEphemerisSnapshotAvailable();              // Map the snapshot of the loaded version, writing it first if needed
+
+private:
+    std::filesystem::path versionDirectory(const std::string& version) const;
+    bool pointHeraDirectoryAt(const std::filesystem::path& target);
 };
 
 // ─────────────────────────────────────────────
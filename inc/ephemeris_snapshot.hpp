@@ -0,0 +1,128 @@
+/*
+ *  Copyright 2025 Mendel Dobondi-Reisz
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef EPHEMERIS_SNAPSHOT_HPP
+#define EPHEMERIS_SNAPSHOT_HPP
+
+// Standard C++ Libraries
+#include <string_view>
+#include <filesystem>
+#include <cstdint>
+#include <string>
+
+// External Libraries
+#include <cspice/SpiceUsr.h>
+
+// Project Headers
+#include <object_catalog.hpp>
+#include <state_cache.hpp>
+#include <spice_core.hpp>
+
+// ─────────────────────────────────────────────
+// Ephemeris Snapshot Parameters
+// ─────────────────────────────────────────────
+#define SNAPSHOT_FILE_NAME "ephemeris.snapshot"     // Inside the kernel version directory, data/hera/ephemeris.snapshot
+#define SNAPSHOT_MAGIC "HERASNAP"
+#define SNAPSHOT_FORMAT_VERSION 1                   // Bumped whenever the file layout changes
+#define SNAPSHOT_START_UTC 1728259200.0             // 2024-10-07T00:00:00 UTC
+#define SNAPSHOT_END_UTC 1830297600.0               // 2028-01-01T00:00:00 UTC
+#define SNAPSHOT_TOLERANCE 1e-4                     // Position tolerance of a valid record in km (10 cm)
+#define SNAPSHOT_MAX_BYTES (2ull << 30)             // Segments are lengthened to stay below, 2 GiB
+#define SNAPSHOT_MAX_LEAP_SECONDS 64
+#define SNAPSHOT_VERSION_LENGTH 64
+#define SNAPSHOT_EPHEMERIS 0x01                     // Object flag: CatalogObject::hasEphemeris
+#define SNAPSHOT_ORIENTATION 0x02                   // Object flag: CatalogObject::hasOrientation
+
+// ─────────────────────────────────────────────
+// Snapshot File Layout - header, then segmentCount x objectCount records
+// ─────────────────────────────────────────────
+struct SnapshotHeader {
+    char magic[8];                                  // SNAPSHOT_MAGIC, not null-terminated
+    uint32_t formatVersion;
+    uint32_t degree;                                // STATE_CACHE_DEGREE
+    uint32_t recordSize;                            // sizeof(SnapshotRecord)
+    uint32_t objectCount;
+    uint64_t segmentCount;
+    SpiceDouble start;                              // ET of the first segment
+    SpiceDouble segmentLength;                      // Seconds per segment
+    SpiceDouble tolerance;                          // Position tolerance of the fits in km
+    char kernelVersion[SNAPSHOT_VERSION_LENGTH];    // Contents of data/hera/version
+
+    // Leap second table of the kernels, so UTC converts to ET without SPICE
+    SpiceDouble deltaTA, k, eb, m[2];
+    uint32_t leapSecondCount;
+    uint32_t reserved;
+    SpiceDouble leapSeconds[SNAPSHOT_MAX_LEAP_SECONDS][2];     // (UTC seconds past J2000, TAI - UTC)
+
+    // Object catalog at build time, in serialization order
+    SpiceInt objectIds[MAX_CATALOG_OBJECTS];
+    uint8_t objectFlags[MAX_CATALOG_OBJECTS];       // SNAPSHOT_* flags
+};
+
+struct SnapshotRecord {
+    uint8_t valid;                                  // 0: no SPICE data or the fit missed the tolerance
+    uint8_t reserved[7];
+    SpiceDouble coefficients[STATE_COMPONENTS][STATE_CACHE_DEGREE + 1];    // SSB-relative geometric state
+};
+
+static_assert(sizeof(SnapshotHeader) % alignof(SnapshotRecord) == 0, "Records follow the header aligned");
+
+// ─────────────────────────────────────────────
+// Ephemeris Snapshot - read-only mapping of one snapshot file
+// ─────────────────────────────────────────────
+class EphemerisSnapshot {
+public:
+    EphemerisSnapshot() = default;
+    EphemerisSnapshot(const EphemerisSnapshot&) = delete;
+    EphemerisSnapshot& operator=(const EphemerisSnapshot&) = delete;
+    ~EphemerisSnapshot();
+
+    bool map(const std::filesystem::path& path);    // false if the file is missing, truncated or of another format
+    bool matches(const std::string& kernelVersion) const;      // Same kernels, catalog and segment length as the server
+
+    /*
+     * Answers a single-epoch 'i' request (13 or 22 bytes) into 'response', formatted like RequestHandler.
+     * Returns false if any part of it is not covered by a valid record - the compute thread answers then.
+     */
+    bool answer(std::string_view request, std::string& response) const;
+    bool relativeState(SpiceDouble et, size_t index, SpiceInt observerId, MotionState& state) const;
+
+private:
+    void* mapping = nullptr;
+    size_t mappingSize = 0;
+    const SnapshotHeader* header = nullptr;
+    const SnapshotRecord* records = nullptr;
+    LeapSecondTable leapSeconds;
+
+    const SnapshotRecord* record(SpiceDouble et, size_t index, SpiceDouble& x) const;
+    bool observerState(SpiceDouble et, SpiceInt observerId, MotionState& state) const;
+};
+
+// ─────────────────────────────────────────────
+// Snapshot Management - written by the data manager, read by every loop thread
+// ─────────────────────────────────────────────
+bool isEphemerisSnapshotEnabled();
+bool writeEphemerisSnapshot(const std::filesystem::path& path, const std::string& kernelVersion);  // Kernels loaded, data manager thread
+bool loadEphemerisSnapshot(const std::filesystem::path& path, const std::string& kernelVersion);   // Maps and publishes the file
+void unloadEphemerisSnapshot();                     // Requests go to the compute thread until the next load
+
+/*
+ * Answers single-epoch 'i' requests and multi-request frames of them from the published snapshot.
+ * Safe from any thread; returns false if there is no snapshot or it does not cover the request.
+ */
+bool answerFromSnapshot(std::string_view request, std::string& response);
+
+#endif // EPHEMERIS_SNAPSHOT_HPP
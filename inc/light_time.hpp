@@ -0,0 +1,79 @@
+/*
+ *  Copyright 2025 Mendel Dobondi-Reisz
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef LIGHT_TIME_HPP
+#define LIGHT_TIME_HPP
+
+// Standard C++ Libraries
+#include <cstdint>
+#include <vector>
+
+// External Libraries
+#include <cspice/SpiceUsr.h>
+
+// Project Headers
+#include <object_catalog.hpp>
+
+// ─────────────────────────────────────────────
+// Light Time Parameters
+// ─────────────────────────────────────────────
+#define LIGHT_TIME_ITERATIONS 1                 // "LT" of spkez_c: one Newtonian iteration ("CN" would be 3)
+#define LIGHT_TIME_ACCELERATION_STEP 1.0        // Observer acceleration from states at et +/- 1 s, as SPICE does
+#define LIGHT_TIME_POSITION_TOLERANCE 1e-5      // km, agreement with spkez_c "LT+S" checked by hera_bench
+#define LIGHT_TIME_VELOCITY_TOLERANCE 1e-8      // km/s
+#define LIGHT_TIME_TOLERANCE 1e-10              // s
+
+// ─────────────────────────────────────────────
+// Light Time Engine - LT+S for all bodies at once
+// ─────────────────────────────────────────────
+
+/*
+ * Solves the reception light time of every selected body together: the SSB table
+ * gives the observer and the first guess, each iteration looks up all targets at
+ * their own et - lt and updates all light times in one arithmetic pass. Stellar
+ * aberration (position and its rate) is then applied to all bodies in one pass.
+ * Arrays are kept per component so the arithmetic passes vectorize.
+ */
+class LightTimeEngine {
+public:
+    bool solve(SpiceDouble et, SpiceInt observerId, uint64_t objectMask);  // false if the observer has no state
+    bool correctedState(const CatalogObject& object, SpiceDouble state[6], SpiceDouble& lightTime) const;
+    void invalidate();                          // Called whenever a kernel version is (re)loaded
+private:
+    bool valid = false;
+    SpiceDouble et = 0.0;
+    SpiceInt observerId = 0;
+    uint64_t solvedMask = 0;
+
+    SpiceDouble observer[6];                    // Observer state relative to the SSB
+    SpiceDouble observerAcceleration[3];
+
+    // Per catalog index
+    std::vector<SpiceDouble> px, py, pz, vx, vy, vz;    // Target relative to the observer, then corrected
+    std::vector<SpiceDouble> lt;
+    std::vector<uint8_t> available;
+    std::vector<SpiceDouble> target;            // Target relative to the SSB at et - lt, 6 per catalog index
+
+    void resize(size_t count);
+};
+
+// ─────────────────────────────────────────────
+// Light Time Engine Instance
+// ─────────────────────────────────────────────
+extern LightTimeEngine lightTimeEngine;
+void invalidateLightTimeEngine();
+
+#endif // LIGHT_TIME_HPP
@@ -0,0 +1,118 @@
+/*
+ *  Copyright 2025 Mendel Dobondi-Reisz
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef METRICS_HPP
+#define METRICS_HPP
+
+// Standard C++ Libraries
+#include <string_view>
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <string>
+
+// ─────────────────────────────────────────────
+// Metrics Layout
+// ─────────────────────────────────────────────
+#define METRICS_ROUTE "/metrics"
+#define METRICS_CONTENT_TYPE "text/plain; version=0.0.4; charset=utf-8"   // Prometheus text exposition format
+#define METRICS_FIRST_OCTAVE 8                  // Lowest bucket ends at 2^8: 256 ns or 256 bytes
+#define METRICS_OCTAVES 30                      // Up to 2^38: ~275 s or 256 GiB, larger values land in +Inf
+#define METRICS_SUB_BUCKET_BITS 2               // 4 linear buckets per power of two, at most 25% wide
+#define METRICS_SUB_BUCKETS (1 << METRICS_SUB_BUCKET_BITS)
+#define METRICS_BUCKETS (METRICS_OCTAVES * METRICS_SUB_BUCKETS + 2)     // Plus the first and the +Inf bucket
+
+enum class MetricsStage : uint8_t {
+    QUEUE,          // Submitted to the compute backend until its computation starts
+    UTC_TO_ET,      // Request timestamp to ephemeris time
+    SPKEZ,          // spkez_c / spkezp_c, once per object the tables do not solve
+    SXFORM,         // sxform_c / pxform_c, once per object with attitude
+    SERIALIZE,      // Response to wire frame: delta / float32 encoding and zstd
+    SEND,           // ws->send of the frame
+    COUNT
+};
+
+enum class MetricsCounter : uint8_t {
+    REQUESTS_I,         // 'i'
+    REQUESTS_L,         // 'l'
+    REQUESTS_RANGE_I,   // 'I'
+    REQUESTS_RANGE_L,   // 'L'
+    REQUESTS_MULTI,     // MULTI_REQUEST_COMMAND
+    REQUESTS_OTHER,     // Unknown mode, answered with 'e'
+    ERRORS_E,           // Responses with mode 'e'
+    ERRORS_F,           // 'f'
+    ERRORS_G,           // 'g'
+    BYTES_IN,           // WebSocket payload bytes received
+    BYTES_OUT,          // WebSocket payload bytes sent, after encoding and compression
+    COUNT
+};
+
+// ─────────────────────────────────────────────
+// Thread Metrics - one writer per block, read by the exporter
+// ─────────────────────────────────────────────
+
+/*
+ * Log-linear histogram in the style of HdrHistogram: a power of two is split into METRICS_SUB_BUCKETS
+ * equal buckets, so every recorded value is known to within 25% from 256 up to 2^38.
+ * Zero-filled memory is an empty histogram.
+ */
+struct MetricsHistogram {
+    std::atomic<uint64_t> buckets[METRICS_BUCKETS];
+    std::atomic<uint64_t> sum;
+
+    void record(uint64_t value);                // Owner thread only
+};
+
+/*
+ * Every counter has a single writer, updates are a relaxed load and store without a locked instruction.
+ * In-process threads get a block on their first update, worker processes write the one in their WorkerSlot.
+ */
+struct alignas(64) ThreadMetrics {
+    std::atomic<uint64_t> counters[static_cast<size_t>(MetricsCounter::COUNT)];
+    MetricsHistogram stages[static_cast<size_t>(MetricsStage::COUNT)];      // Nanoseconds
+    MetricsHistogram buffered;                  // Bytes waiting in the socket after each send
+};
+
+size_t metricsBucket(uint64_t value);
+uint64_t metricsBucketBound(size_t bucket);    // Largest value of the bucket plus one, UINT64_MAX for +Inf
+
+// ─────────────────────────────────────────────
+// Metrics Recording - hot path
+// ─────────────────────────────────────────────
+bool isMetricsEnabled();
+uint64_t steadyNanoseconds();                   // Clock of the stage timers and request traces
+void bindThreadMetrics(ThreadMetrics* block);   // Worker processes: the block in their shared memory slot
+
+void countMetric(MetricsCounter counter, uint64_t amount = 1);
+void countRequest(std::string_view request);    // By mode byte
+void countResponse(std::string_view response);  // Error responses by mode byte
+void recordBuffered(size_t bytes);
+
+uint64_t stageStart();                          // 0 while metrics are disabled
+void recordStage(MetricsStage stage, uint64_t start);   // Nothing for a start of 0
+
+// ─────────────────────────────────────────────
+// Kernel Metrics - data manager thread
+// ─────────────────────────────────────────────
+void recordKernelSync();                        // The remote version was checked
+void recordKernelSwap(const std::string& version);      // A kernel version was loaded or swapped in
+
+// ─────────────────────────────────────────────
+// Metrics Export - Prometheus text format
+// ─────────────────────────────────────────────
+std::string renderMetrics();                    // Sums every thread and worker block, any thread
+
+#endif // METRICS_HPP
@@ -0,0 +1,83 @@
+/*
+ *  Copyright 2025 Mendel Dobondi-Reisz
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef OBJECT_CATALOG_HPP
+#define OBJECT_CATALOG_HPP
+
+// Standard C++ Libraries
+#include <string_view>
+#include <cstdint>
+#include <utility>
+#include <string>
+#include <vector>
+
+// External Libraries
+#include <cspice/SpiceUsr.h>
+
+// ─────────────────────────────────────────────
+// Default Objects - all relevant objects in the mission
+// ─────────────────────────────────────────────
+const std::vector<std::pair<SpiceInt, std::string_view>> defaultObjects = {
+    {0, "SOLAR_SYSTEM_BARYCENTER"},
+    {10, "SUN"},
+    {199, "MERCURY"},
+    {299, "VENUS"},
+    {399, "EARTH"},
+    {301, "MOON"},
+    {499, "MARS"},
+    {401, "PHOBOS"},
+    {402, "DEIMOS"},
+    {-658030, "DIDYMOS"},
+    {-658031, "DIMORPHOS"},
+    {-91900, "DART_IMPACT_SITE"},
+    {-91000, "HERA_SPACECRAFT"},
+    {-9101000, "JUVENTAS_SPACECRAFT"},
+    {-9102000, "MILANI_SPACECRAFT"}
+};
+
+#define MAX_CATALOG_OBJECTS 64                  // Objects are addressed by bit index in 64-bit masks
+
+// ─────────────────────────────────────────────
+// Object Catalog - resolved once per kernel version
+// ─────────────────────────────────────────────
+struct CatalogObject {
+    SpiceInt id;
+    std::string name;
+    std::string frameName;                      // Body-fixed frame, empty if none was found
+    SpiceInt frameId;
+    bool hasEphemeris;                          // Target of a loaded SPK segment (or the SSB)
+    bool hasOrientation;                        // Has a body-fixed frame to rotate into
+    uint8_t index;                              // Serialization order, stable for a given catalog
+};
+
+struct CatalogEntryConfig {
+    SpiceInt id;
+    std::string name;
+    std::string frameName;                      // Optional override, resolved from the kernels if empty
+};
+
+/*
+ * Objects in serialization order: the order of the catalog file, or of defaultObjects.
+ * Rebuilt by initSpiceCore after every kernel load, read-only while requests run.
+ */
+extern std::vector<CatalogObject> objectCatalog;
+
+void buildObjectCatalog();
+void clearObjectCatalog();
+bool loadCatalogConfig(const std::string& path, std::vector<CatalogEntryConfig>& entries);
+const CatalogObject* findCatalogObject(SpiceInt id);
+
+#endif // OBJECT_CATALOG_HPP
@@ -0,0 +1,95 @@
+/*
+ *  Copyright 2025 Mendel Dobondi-Reisz
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef PREFETCH_MANAGER_HPP
+#define PREFETCH_MANAGER_HPP
+
+// Standard C++ Libraries
+#include <string_view>
+#include <cstdint>
+#include <string>
+#include <deque>
+
+// Project Headers
+#include <websocket_manager.hpp>
+
+// ─────────────────────────────────────────────
+// Prefetch Parameters
+// ─────────────────────────────────────────────
+#define PREFETCH_MAX_DEPTH 8                // Frames computed ahead of one connection
+#define PREFETCH_MIN_STREAK 3               // Requests at the same step before frames are computed ahead
+#define PREFETCH_QUEUE_LIMIT 64             // Prefetch tasks waiting for the compute backend, all connections
+#define PREFETCH_STEP_TOLERANCE 1e-3        // Relative deviation from the step that still continues a cadence
+#define PREFETCH_MATCH_ULPS 16              // A frame answers a request whose timestamp is this close, last + k * step rounds
+
+// ─────────────────────────────────────────────
+// Prefetch Stream - request cadence of one connection
+// ─────────────────────────────────────────────
+struct PrefetchedFrame {
+    double timestamp;
+    std::string request;                    // Request the frame was computed for
+    std::string response;                   // Empty while it is computed
+    uint64_t generation;                    // Response cache generation, frames of older kernels are stale
+    std::string waitingRequest;             // Set when the client asked for the frame while it was computed
+    uWS::OpCode waitingOpCode = uWS::OpCode::BINARY;
+    uint64_t waitingTrace = 0;              // Its sampled trace, ended when the frame is sent
+};
+
+struct PrefetchStream {
+    uint64_t session;
+    std::string signature;                  // Request without its timestamp: mode, observer, selection
+    double lastTimestamp = 0.0;
+    double step = 0.0;                      // Seconds between requests, negative when playing backwards
+    int streak = 0;                         // Requests in a row at this step
+    std::deque<PrefetchedFrame> frames;     // Ahead of the client, in request order
+};
+
+enum class PrefetchResult : uint8_t {
+    MISS,                                   // Not ahead of the client, computed as usual
+    SENT,                                   // Answered from a stored frame
+    WAITING                                 // Attached to a frame that is still computed, sent by completePrefetch
+};
+
+struct PrefetchStats {
+    uint64_t hits;                          // Steady-stream requests answered from a prefetched frame
+    uint64_t misses;                        // Steady-stream requests that had to be computed
+    uint64_t computed;                      // Frames submitted ahead of the client
+};
+
+// ─────────────────────────────────────────────
+// Prefetch Handlers - loop thread only
+// ─────────────────────────────────────────────
+bool isPrefetchEnabled();
+bool isPrefetchableRequest(std::string_view request);      // Single-epoch 'i'/'l', with or without selection
+
+/*
+ * Follows the cadence of the connection and answers the request from its prefetched frames.
+ * A request attached to a frame that is still computed keeps the current trace until it is sent.
+ */
+PrefetchResult takePrefetched(WS* ws, const std::string& request, uWS::OpCode opCode);
+
+/*
+ * Computes the next frames of the connection's steady stream ahead on idle compute capacity.
+ * Called once the client's own request was answered, nothing is submitted while client requests
+ * of any connection wait for the compute backend.
+ */
+void schedulePrefetch(WS* ws, uWS::OpCode opCode);
+void completePrefetch(WS* ws, const std::string& request, std::string&& response, uint64_t generation);
+void endPrefetch(WS* ws);                   // Called when the socket closes
+
+PrefetchStats prefetchStats();
+
+#endif // PREFETCH_MANAGER_HPP
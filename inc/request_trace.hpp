@@ -0,0 +1,109 @@
+/*
+ *  Copyright 2025 Mendel Dobondi-Reisz
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef REQUEST_TRACE_HPP
+#define REQUEST_TRACE_HPP
+
+// Standard C++ Libraries
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+
+// ─────────────────────────────────────────────
+// Trace Layout
+// ─────────────────────────────────────────────
+#define TRACE_RING_EVENTS 8192                  // Events kept per thread or worker process, must be a power of two
+#define TRACE_THREAD_NAME_LENGTH 32
+#define TRACE_COMMAND "trace"                   // Typed into the terminal like `exit`
+#define TRACE_FILE_PREFIX "hera_trace."         // hera_trace.<unix time>.json in the working directory
+
+static_assert((TRACE_RING_EVENTS & (TRACE_RING_EVENTS - 1)) == 0, "Trace ring size must be a power of two");
+
+enum class TraceStage : uint8_t {
+    REQUEST_BEGIN,      // Async span of the whole request: received ...
+    REQUEST_END,        // ... until its response was sent
+    ON_MESSAGE,         // onMessage until the request was answered or handed over
+    PREFETCH,           // takePrefetched
+    RESPONSE_CACHE,     // responseCache.lookup
+    SNAPSHOT,           // answerFromSnapshot
+    SUBMIT,             // submitComputeTask, including computeMutex
+    QUEUE,              // Submitted until the compute thread or the worker dispatcher took it
+    SPICE_MUTEX,        // Waiting for spiceMutex and SPICE data
+    WORKER_RING,        // Pushed into a worker's request ring until the worker took it
+    REQUEST_HANDLER,    // processRequest
+    UTC_TO_ET,          // RequestHandler::setETime
+    BARYCENTRIC_TABLE,  // RequestHandler::prepareBarycentricTable
+    LIGHT_TIME_ENGINE,  // RequestHandler::prepareLightTimeEngine
+    LOAD_STATE,         // ObjectData::loadState, one per object
+    DELIVER,            // Response cache insert and posting to the loops
+    LOOP_WAIT,          // Posted until the loop ran the deferred send
+    SEND,               // Encoding, compression and ws->send
+    COUNT
+};
+
+// ─────────────────────────────────────────────
+// Trace Ring - one writer, lives in process or shared memory
+// ─────────────────────────────────────────────
+
+/*
+ * Every field is atomic so a dump can read while the owner writes: 'sequence' is cleared before
+ * an event is rewritten and set to its ring position + 1 after, events that changed while they
+ * were copied are skipped. Zero-filled memory is an empty ring.
+ */
+struct TraceEvent {
+    std::atomic<uint64_t> sequence;
+    std::atomic<uint64_t> trace;
+    std::atomic<uint64_t> start;                // steady_clock ns: CLOCK_MONOTONIC, the same in every process
+    std::atomic<uint64_t> duration;
+    std::atomic<uint64_t> detail;               // Stage in the low byte, NAIF id of LOAD_STATE in the high 32 bits
+};
+
+struct alignas(64) TraceRing {
+    std::atomic<uint64_t> head;                 // Events written so far
+    std::atomic<int32_t> pid;
+    std::atomic<int32_t> tid;
+    char name[TRACE_THREAD_NAME_LENGTH];        // Set when the ring is bound, before the first event
+    TraceEvent events[TRACE_RING_EVENTS];
+};
+
+// ─────────────────────────────────────────────
+// Request Tracing - hot path
+// ─────────────────────────────────────────────
+bool isTracingEnabled();
+uint64_t sampleTrace();                         // Loop thread: a new trace id for one in --trace <n> requests, else 0
+
+// The request the calling thread works on, every stage below is recorded for it
+uint64_t currentTrace();
+void setCurrentTrace(uint64_t trace);
+
+uint64_t traceStart();                          // 0 unless the current request is traced
+void traceStage(TraceStage stage, uint64_t start, int32_t object = 0);  // From start until now, nothing for 0
+void traceInstant(TraceStage stage);
+
+void nameTraceThread(const char* name);         // Shown in the dump, before the thread's first event
+void bindTraceRing(TraceRing* ring, const char* name);     // Worker processes: the ring in their shared memory
+
+// ─────────────────────────────────────────────
+// Trace Export - Chrome Trace Event format
+// ─────────────────────────────────────────────
+
+/*
+ * Writes every event still in the rings of the server threads and worker processes as
+ * Chrome Trace Event JSON, readable by chrome://tracing and Perfetto. Any thread.
+ */
+bool dumpTrace();
+
+#endif // REQUEST_TRACE_HPP
@@ -0,0 +1,84 @@
+/*
+ *  Copyright 2025 Mendel Dobondi-Reisz
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef RESPONSE_CACHE_HPP
+#define RESPONSE_CACHE_HPP
+
+// Standard C++ Libraries
+#include <unordered_map>
+#include <string_view>
+#include <cstdint>
+#include <atomic>
+#include <string>
+#include <mutex>
+#include <list>
+
+// ─────────────────────────────────────────────
+// Response Cache Key - quantized request
+// ─────────────────────────────────────────────
+struct ResponseCacheKey {
+    int64_t quantizedTime;      // round(utcTimestamp / quantum)
+    uint8_t mode;
+    int32_t observerId;
+    bool operator==(const ResponseCacheKey& other) const;
+};
+
+struct ResponseCacheKeyHash {
+    size_t operator()(const ResponseCacheKey& key) const;
+};
+
+struct ResponseCacheStats {
+    uint64_t hits;
+    uint64_t misses;
+    size_t entries;
+};
+
+// ─────────────────────────────────────────────
+// Response Cache - bounded LRU of serialized responses
+// ─────────────────────────────────────────────
+class ResponseCache {
+public:
+    /*
+     * Copies the cached response for the request into 'response'.
+     * Without snapping, the echoed timestamp is replaced by the one in the request.
+     */
+    bool lookup(std::string_view request, std::string& response);
+    void insert(std::string_view request, std::string_view response, uint64_t generation);
+    void flush();                           // Drops every entry and rejects responses computed before the flush
+    uint64_t generation() const;
+    ResponseCacheStats stats();
+private:
+    using Entry = std::pair<ResponseCacheKey, std::string>;
+
+    std::mutex mutex;
+    std::list<Entry> entries;               // Most recently used first
+    std::unordered_map<ResponseCacheKey, std::list<Entry>::iterator, ResponseCacheKeyHash> index;
+    std::atomic<uint64_t> currentGeneration = 0;
+    std::atomic<uint64_t> hits = 0;
+    std::atomic<uint64_t> misses = 0;
+};
+
+// ─────────────────────────────────────────────
+// Response Cache Instance
+// ─────────────────────────────────────────────
+extern ResponseCache responseCache;
+bool isResponseCacheEnabled();
+bool isCacheableRequest(std::string_view request);
+bool makeResponseCacheKey(std::string_view request, ResponseCacheKey& key);
+void snapRequestTimestamp(std::string& request);   // Moves the timestamp onto the quantum grid
+void flushResponseCache();                          // Called whenever a kernel version is (re)loaded
+
+#endif // RESPONSE_CACHE_HPP
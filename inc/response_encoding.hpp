@@ -0,0 +1,75 @@
+/*
+ *  Copyright 2025 Mendel Dobondi-Reisz
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef RESPONSE_ENCODING_HPP
+#define RESPONSE_ENCODING_HPP
+
+// Standard C++ Libraries
+#include <string_view>
+#include <cstdint>
+#include <string>
+
+// ─────────────────────────────────────────────
+// Encoding Negotiation
+// ─────────────────────────────────────────────
+#define ENCODING_COMMAND 'E'
+#define ENCODING_MESSAGE_LENGTH 2       // 'E', ENCODING_* flags
+#define ENCODING_FLOAT32 0x01           // Vectors and quaternions as float32
+#define ENCODING_QUAT16 0x02            // Quaternions as smallest-three: largest index + 3 int16
+#define ENCODING_DELTA 0x04             // Values coded against the previous frame of the connection
+#define ENCODING_ZSTD 0x08              // Frames above the compression threshold are sent zstd compressed
+#define ENCODING_VALUES 0x07            // Flags that change how values are written
+#define ENCODING_ALL 0x0F
+#define ENCODING_DELTA_FRAME 0x80       // Set on the encoding byte of a frame that needs the previous one
+#define ENCODED_HEADER_SIZE 10          // Timestamp, mode, encoding byte
+#define COMPRESSED_MODE 'z'             // Mode byte of a compressed frame
+#define COMPRESSED_HEADER_SIZE 13       // Timestamp, 'z', uint32 size of the original frame
+
+// ─────────────────────────────────────────────
+// Encoding State - one per connection, loop thread only
+// ─────────────────────────────────────────────
+struct EncodingState {
+    uint8_t encoding = 0;           // ENCODING_* flags, 0 sends responses as computed
+    std::string layout;             // Mode, components and object ids of the previous frame
+    std::string previous;           // Fixed-width values of the previous frame, the base of the next delta
+
+    void reset();                   // Next frame is a key frame
+};
+
+// ─────────────────────────────────────────────
+// Response Encoding
+// ─────────────────────────────────────────────
+uint8_t requestComponents(std::string_view request);       // COMPONENT_* bits the response carries
+
+/*
+ * Encodes a single-epoch response with the negotiated encoding into 'frame'.
+ * Returns false if the response stays as it is: encoding off, range responses and errors.
+ */
+bool encodeResponse(std::string_view response, uint8_t components, EncodingState& state, std::string& frame);
+
+/*
+ * Byte-shuffles the frame in 8-byte lanes, so the like bytes of neighbouring doubles line up, and zstd compresses it.
+ * Returns false if compression fails or does not make the frame smaller.
+ */
+bool compressFrame(std::string_view frame, int level, std::string& compressed);
+
+/*
+ * The response as sent on a connection: encoded, then compressed if it reaches --compress-threshold.
+ * Points into buffers of the calling thread, valid until its next call. 'large' asks for permessage-deflate.
+ */
+std::string_view serializeFrame(std::string_view response, uint8_t components, EncodingState& state, bool& large);
+
+#endif // RESPONSE_ENCODING_HPP
@@ -23,6 +23,7 @@
 
 // Project Headers
 #include <websocket_manager.hpp>
+#include <worker_pool.hpp>
 
 #define ENTRY_POINT "/ws/"
 
@@ -37,6 +38,24 @@
  */
 void dataManagerWorker(int syncInterval);
 
+// ─────────────────────────────────────────────
+// SPICE Compute Thread - ComputeManager
+// ─────────────────────────────────────────────
+
+/*
+ * Takes queued requests off the event loop and evaluates them with SPICE.
+ * Waits for kernel data while it is being updated, so the event loop never has to.
+ * Responses are posted back to the owning loop with uWS::Loop::defer.
+ */
+void computeManagerWorker();
+
+/*
+ * Compute thread body when SPICE runs in worker processes.
+ * Moves queued requests into the shared memory rings and delivers the responses.
+ * Requests lost to a crashed worker are resubmitted.
+ */
+void workerPoolDispatcher(WorkerPool& pool);
+
 // ─────────────────────────────────────────────
 // uWebSocket Thread - WebSocketManager
 // ─────────────────────────────────────────────
@@ -48,6 +67,12 @@ void dataManagerWorker(int syncInterval);
  */
 void webSocketManagerWorker(int port);
 
+/*
+ * Body of one event loop thread: its own uWS::App listening on the shared port.
+ * webSocketManagerWorker runs loop 0 itself and one thread per further loop.
+ */
+void webSocketLoopWorker(int port, WebSocketLoop* state);
+
 // ─────────────────────────────────────────────
 // Graceful Shutdown - stop worker threads
 // ─────────────────────────────────────────────
@@ -57,9 +82,10 @@ extern std::mutex shutdownMutex;
 extern std::condition_variable shutdownCV;
 
 extern std::thread* dataManagerPointer;
+extern std::thread* computeManagerPointer;
 extern std::thread* webSocketManagerPointer;
 
-void gracefulShutdown(std::thread* dataManagerPointer, std::thread* webSocketManagerPointer);
+void gracefulShutdown(std::thread* dataManagerPointer, std::thread* computeManagerPointer, std::thread* webSocketManagerPointer);
 void handleSignal(int signal);
 
 #endif // SERVER_THREADS_HPP
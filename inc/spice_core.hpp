@@ -21,31 +21,17 @@
 #include <unordered_map>
 #include <filesystem>
 #include <cstdint>
+#include <utility>
 #include <string>
+#include <vector>
 
 // External Libraries
 #include <cspice/SpiceUsr.h>
 
-// ─────────────────────────────────────────────
-// Objects - all relevant objects in the mission
-// ─────────────────────────────────────────────
-const std::unordered_map<SpiceInt, std::string_view> objects = {
-    {0, "SOLAR_SYSTEM_BARYCENTER"},
-    {10, "SUN"},
-    {199, "MERCURY"},
-    {299, "VENUS"},
-    {399, "EARTH"},
-    {301, "MOON"},
-    {499, "MARS"},
-    {401, "PHOBOS"},
-    {402, "DEIMOS"},
-    {-658030, "DIDYMOS"},
-    {-658031, "DIMORPHOS"},
-    {-91900, "DART_IMPACT_SITE"},
-    {-91000, "HERA_SPACECRAFT"},
-    {-9101000, "JUVENTAS_SPACECRAFT"},
-    {-9102000, "MILANI_SPACECRAFT"}
-};
+// Project Headers
+#include <barycentric_table.hpp>
+#include <object_catalog.hpp>
+#include <light_time.hpp>
 
 // ─────────────────────────────────────────────
 // Object Motion State Data
@@ -58,22 +44,35 @@ struct MotionState {
     Quaternion orientation;
     Vector angularVelocity;
 };
+static_assert(sizeof(MotionState) == 13 * sizeof(SpiceDouble), "MotionState is serialized as 13 packed doubles");
 
 // ─────────────────────────────────────────────
 // Object Data - motion snapshots for objects
 // ─────────────────────────────────────────────
+#define COMPONENT_POSITION 0x01
+#define COMPONENT_VELOCITY 0x02
+#define COMPONENT_ORIENTATION 0x04
+#define COMPONENT_ANGULAR_VELOCITY 0x08
+#define COMPONENT_ALL 0x0F
+
+size_t objectDataSize(uint8_t components);     // Serialized ObjectData with the given components
+
 class ObjectData {
 public:
-    ObjectData(SpiceDouble et, SpiceInt objectId, SpiceInt observerId, bool lightTimeAdjusted);
+    ObjectData(SpiceDouble et, const CatalogObject& object, SpiceInt observerId, bool lightTimeAdjusted,
+               uint8_t components = COMPONENT_ALL, BarycentricTable* barycentric = nullptr,
+               const LightTimeEngine* lightTime = nullptr);
     void serializeToBinary(std::string& buffer) const;
+    bool isAvailable() const;
 private:
     SpiceDouble et;
     SpiceInt objectId;
     SpiceInt observerId;
     SpiceBoolean lightTimeAdjusted;
+    uint8_t components;                         // COMPONENT_* bits that are computed and serialized
     MotionState objectState;
     SpiceBoolean stateAvailable;
-    bool loadState();
+    bool loadState(const CatalogObject& object, BarycentricTable* barycentric, const LightTimeEngine* lightTime);
 };
 
 // ─────────────────────────────────────────────
@@ -82,11 +81,35 @@ private:
 enum class MessageMode : uint8_t {
     ALL_INSTANTANEOUS = 'i',
     ALL_LIGHT_TIME_ADJUSTED = 'l',
+    RANGE_INSTANTANEOUS = 'I',
+    RANGE_LIGHT_TIME_ADJUSTED = 'L',
     ERROR = 'e',
     ERROR_I = 'f',
     ERROR_L = 'g'
 };
 
+#define MESSAGE_FLAG_TDB 0x80                   // Mode flag: the timestamp is TDB seconds past J2000, not Unix UTC
+
+// ─────────────────────────────────────────────
+// Range Requests - N samples in one frame
+// ─────────────────────────────────────────────
+#define MAX_RANGE_SAMPLES 4096                  // Hard cap on samples per range request
+#define MAX_RANGE_FRAME_SIZE (8 * 1024 * 1024)  // Hard cap on the size of a range response
+#define OBJECT_DATA_SIZE 108                    // Serialized ObjectData with every component: id + 13 doubles
+
+bool isRangeMode(MessageMode mode);
+
+// ─────────────────────────────────────────────
+// Multi-Requests - K single-epoch requests in one frame
+// ─────────────────────────────────────────────
+bool isMultiRequest(std::string_view request);
+
+/*
+ * Answers a single request or a multi-request frame into 'responseBuffer'.
+ * A multi-request is answered with 'M', the echoed count byte, then a uint32 length and the reply of every request in order.
+ */
+std::string_view processRequest(std::string_view request, std::string& responseBuffer);
+
 // ─────────────────────────────────────────────
 // Request - processing incoming requests
 // ─────────────────────────────────────────────
@@ -99,22 +122,44 @@ private:
     SpiceDouble utcTimestamp;
     MessageMode mode;
     SpiceInt observerId;
+    bool tdbTimestamp;                              // MESSAGE_FLAG_TDB was set on the mode byte
+
+    // Range request data
+    SpiceDouble endTimestamp;
+    SpiceDouble step;                               // > 0: seconds between samples, < 0: -(sample count)
+    uint32_t sampleCount;
+
+    // Selection trailer - every object and component unless the request carries one
+    uint64_t objectMask;                            // Bit n selects objectCatalog[n]
+    uint8_t componentMask;                          // COMPONENT_* bits
 
     // Request, response containers
     std::string_view request;
-    std::string message;
+    std::string ownMessage;                         // Response storage unless the caller passes a buffer
+    std::string& message;
 
     // Request setters
     void setETime(SpiceDouble utcTimestamp);
+    SpiceDouble toEt(SpiceDouble timestamp) const;  // Request timestamp (UTC or TDB) to ephemeris time
     void setMode(MessageMode mode);
     void setObserverId(SpiceInt observerId);
     
     // Message writers
     int writeHeader();                              // Writes the header to the message buffer: 0 success, 1 failiure
     int writeData(SpiceBoolean lightTimeAdjusted);  // Writes the data to the message buffer: 0 success, 1 failiure
+    int writeRangeData(SpiceBoolean lightTimeAdjusted);    // Writes every sample of a range request: 0 success, 1 failiure
+
+    // Range helpers
+    bool loadRange();                               // Validates the range and computes the sample count
+    bool loadSelection();                           // Reads the optional selection trailer, false if it or the length is invalid
+    size_t selectedObjectCount() const;
+    BarycentricTable* prepareBarycentricTable(SpiceDouble et, bool lightTimeAdjusted) const;   // nullptr: per-object spkez_c
+    const LightTimeEngine* prepareLightTimeEngine(SpiceDouble et, bool lightTimeAdjusted) const;
+    SpiceDouble sampleTimestamp(uint32_t index) const;
 
 public:
     RequestHandler(std::string_view incomingRequest);
+    RequestHandler(std::string_view incomingRequest, std::string& responseBuffer);   // Reuses the buffer's capacity
     
     // Message modifiers
     void clearMessage();
@@ -122,6 +167,7 @@ public:
 
     // Getter
     std::string getMessage() const;
+    std::string_view messageView() const;           // Valid while the response buffer is untouched
 };
 
 // ─────────────────────────────────────────────
@@ -131,9 +177,27 @@ extern bool kernelPathsLoaded;
 extern std::filesystem::path cremaMetakernel;
 extern std::filesystem::path operationalMetakernel;
 extern std::filesystem::path planMetakernel;
+
+// Leap seconds - read from the LSK whenever kernels are loaded
+struct LeapSecondTable {
+    bool loaded = false;
+    SpiceDouble deltaTA;                            // DELTET/DELTA_T_A: TDT - TAI
+    SpiceDouble k;                                  // DELTET/K
+    SpiceDouble eb;                                 // DELTET/EB
+    SpiceDouble m[2];                               // DELTET/M
+    std::vector<std::pair<SpiceDouble, SpiceDouble>> deltaAt;  // (UTC seconds past J2000 of the leap, TAI - UTC)
+};
+extern LeapSecondTable leapSeconds;
+bool loadLeapSecondTable();
+
 void initSpiceCore();
 void deinitSpiceCore();
-SpiceDouble etTime(SpiceDouble utcTimestamp);
+bool computeMotionState(SpiceDouble et, SpiceInt objectId, SpiceInt observerId, bool lightTimeAdjusted,
+                        const char* bodyFixedFrame, MotionState& state,
+                        uint8_t components = COMPONENT_ALL);             // Direct SPICE evaluation of the components
+SpiceDouble etTime(SpiceDouble utcTimestamp);       // Arithmetic from the leap second table, str2et_c if not loaded
+SpiceDouble etTimeFromTable(SpiceDouble utcTimestamp, const LeapSecondTable& table);   // Arithmetic only, no SPICE calls
+SpiceDouble etTimeFromString(SpiceDouble utcTimestamp); // utcTimeString + str2et_c
 std::string getBodyFixedFrameName(SpiceInt id);
 std::string utcTimeString(SpiceDouble utcTimestamp);
 std::string getName(SpiceInt id);
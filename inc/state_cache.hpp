@@ -0,0 +1,105 @@
+/*
+ *  Copyright 2025 Mendel Dobondi-Reisz
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef STATE_CACHE_HPP
+#define STATE_CACHE_HPP
+
+// Standard C++ Libraries
+#include <unordered_map>
+#include <cstdint>
+#include <vector>
+#include <mutex>
+
+// External Libraries
+#include <cspice/SpiceUsr.h>
+
+// Project Headers
+#include <spice_core.hpp>
+
+// ─────────────────────────────────────────────
+// State Cache Parameters
+// ─────────────────────────────────────────────
+#define STATE_CACHE_DEGREE 10               // Chebyshev degree per segment (11 SPICE samples per fit)
+#define STATE_CACHE_MAX_DEPTH 6             // A window is bisected at most 6 times (window / 64)
+#define STATE_CACHE_MAX_WINDOWS 20000       // Cache is dropped as a whole beyond this many windows
+#define STATE_CACHE_RATE_SCALE 1e-3         // Rate tolerances: value tolerance x 1e-3 per second
+#define STATE_CACHE_ANGLE_TOLERANCE 1e-6    // Orientation tolerance in radians (~0.2 arcsec)
+#define STATE_COMPONENTS 13                 // Position 3, velocity 3, quaternion 4, angular velocity 3
+
+// ─────────────────────────────────────────────
+// Chebyshev Helpers
+// ─────────────────────────────────────────────
+void chebyshevNodes(int degree, SpiceDouble* nodes);                                    // degree + 1 nodes on [-1, 1]
+void chebyshevFit(const SpiceDouble* values, int degree, SpiceDouble* coefficients);    // values sampled at the nodes
+SpiceDouble chebyshevEvaluate(const SpiceDouble* coefficients, int degree, SpiceDouble x);
+
+/*
+ * Fits all 13 state components over [start, end] from SPICE samples at the Chebyshev nodes.
+ * Returns false if SPICE has no data there or the fit misses the position tolerance (km) at a checkpoint.
+ */
+bool fitStateSegment(SpiceDouble start, SpiceDouble end, SpiceInt objectId, SpiceInt observerId, bool lightTimeAdjusted,
+                     const char* bodyFixedFrame, SpiceDouble tolerance,
+                     SpiceDouble coefficients[STATE_COMPONENTS][STATE_CACHE_DEGREE + 1]);
+void evaluateStateSegment(const SpiceDouble coefficients[STATE_COMPONENTS][STATE_CACHE_DEGREE + 1],
+                          SpiceDouble x, MotionState& state);      // x in [-1, 1] over the fitted span
+
+// ─────────────────────────────────────────────
+// State Cache - Chebyshev fits of SPICE states
+// ─────────────────────────────────────────────
+struct StateSegment {
+    SpiceDouble start;
+    SpiceDouble end;
+    bool valid;                             // false: the fit missed the tolerance, evaluate SPICE directly
+    SpiceDouble coefficients[STATE_COMPONENTS][STATE_CACHE_DEGREE + 1];
+};
+
+struct StateCacheKey {
+    SpiceInt objectId;
+    SpiceInt observerId;
+    bool lightTimeAdjusted;
+    int64_t window;                         // floor(et / window length)
+    bool operator==(const StateCacheKey& other) const;
+};
+
+struct StateCacheKeyHash {
+    size_t operator()(const StateCacheKey& key) const;
+};
+
+class StateCache {
+public:
+    /*
+     * Fills 'state' from the cached polynomials, fitting the window on first use.
+     * Returns false if the epoch is not covered by a valid fit - the caller evaluates SPICE then.
+     */
+    bool lookup(SpiceDouble et, SpiceInt objectId, SpiceInt observerId, bool lightTimeAdjusted,
+                const char* bodyFixedFrame, MotionState& state);
+    void invalidate();
+private:
+    std::mutex mutex;
+    std::unordered_map<StateCacheKey, std::vector<StateSegment>, StateCacheKeyHash> windows;
+
+    void fitSegment(SpiceDouble start, SpiceDouble end, int depth, SpiceInt objectId, SpiceInt observerId,
+                    bool lightTimeAdjusted, const char* bodyFixedFrame, std::vector<StateSegment>& segments);
+};
+
+// ─────────────────────────────────────────────
+// State Cache Instance
+// ─────────────────────────────────────────────
+extern StateCache stateCache;
+bool isStateCacheEnabled();
+void invalidateStateCache();                // Called whenever a kernel version is (re)loaded
+
+#endif // STATE_CACHE_HPP
@@ -0,0 +1,79 @@
+/*
+ *  Copyright 2025 Mendel Dobondi-Reisz
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef SUBSCRIPTION_MANAGER_HPP
+#define SUBSCRIPTION_MANAGER_HPP
+
+// Standard C++ Libraries
+#include <string_view>
+#include <cstdint>
+#include <chrono>
+#include <string>
+
+// Project Headers
+#include <websocket_manager.hpp>
+
+// ─────────────────────────────────────────────
+// Subscription Messages
+// ─────────────────────────────────────────────
+#define SUBSCRIBE_MESSAGE_LENGTH 30         // 'S', mode, observer, start, rate, frame rate
+#define SUBSCRIPTION_CONTROL_LENGTH 1       // 'U', 'P' or 'R'
+#define SUBSCRIPTION_MAX_FRAME_RATE 240.0   // Frames per second
+#define SUBSCRIPTION_TICK_MS 4              // Loop timer period while any subscription is active
+
+enum class SubscriptionCommand : uint8_t {
+    SUBSCRIBE = 'S',
+    UNSUBSCRIBE = 'U',
+    PAUSE = 'P',
+    RESUME = 'R'
+};
+
+// ─────────────────────────────────────────────
+// Subscription - simulation clock of one connection
+// ─────────────────────────────────────────────
+struct Subscription {
+    using Clock = std::chrono::steady_clock;
+
+    uint64_t serial;                // Changes with every subscribe, frames of an older one are dropped
+    uint64_t session;
+    std::string request;            // Frame request template, the timestamp is filled in per frame
+    uWS::OpCode opCode;             // Opcode of the subscribe message, frames are sent with it
+    double anchorEpoch;             // Simulation time at anchorTime
+    Clock::time_point anchorTime;
+    double rate;                    // Simulation seconds per wall-clock second
+    Clock::duration period;         // Wall-clock time between frames
+    Clock::time_point nextFrame;
+    bool paused = false;
+    bool inFlight = false;          // A frame is being computed, the next one waits for it
+    uint64_t frames = 0;
+    uint64_t skipped = 0;           // Ticks dropped because the client or the compute backend lagged
+
+    double epoch(Clock::time_point now) const;
+};
+
+// ─────────────────────────────────────────────
+// Subscription Handlers - loop thread only
+// ─────────────────────────────────────────────
+
+/*
+ * Handles subscribe/unsubscribe/pause/resume messages.
+ * Returns false if the message is not a subscription message, it is then handled as a request.
+ */
+bool handleSubscriptionMessage(WS* ws, std::string_view message, uWS::OpCode opCode);
+void endSubscription(WS* ws);                               // Called when the socket closes
+bool completeSubscriptionFrame(WS* ws, uint64_t serial);    // false: the frame belongs to an ended subscription
+
+#endif // SUBSCRIPTION_MANAGER_HPP
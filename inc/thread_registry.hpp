@@ -0,0 +1,63 @@
+/*
+ *  Copyright 2025 Mendel Dobondi-Reisz
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef THREAD_REGISTRY_HPP
+#define THREAD_REGISTRY_HPP
+
+// Standard C++ Libraries
+#include <atomic>
+
+// ─────────────────────────────────────────────
+// Thread Registry - one block per thread, read by any thread
+// ─────────────────────────────────────────────
+
+/*
+ * A thread gets its block on first use, or binds one that lives elsewhere (a worker's shared memory).
+ * Blocks are never freed, so readers walk the list without a lock while threads push to its head.
+ * The binding is thread_local per Block type: keep one registry per type.
+ */
+template <typename Block>
+class ThreadRegistry {
+public:
+    template <typename Init>
+    Block& current(Init init) {
+        if (bound) return *bound;
+
+        Node* node = new Node();
+        init(node->block);
+        node->next = head.load(std::memory_order_relaxed);
+        while (!head.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed)) {}
+        return *(bound = &node->block);
+    }
+    Block& current() { return current([](Block&) {}); }
+
+    void bind(Block* block) { bound = block; }
+
+    template <typename Visit>
+    void forEach(Visit visit) const {
+        for (const Node* node = head.load(std::memory_order_acquire); node; node = node->next) visit(node->block);
+    }
+private:
+    struct Node {
+        Block block = {};
+        Node* next = nullptr;
+    };
+
+    std::atomic<Node*> head = nullptr;
+    static inline thread_local Block* bound = nullptr;
+};
+
+#endif // THREAD_REGISTRY_HPP
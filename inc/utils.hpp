@@ -18,6 +18,7 @@
 #define HELPER_HPP
 
 // Standard C++ Libraries
+#include <cstddef>
 #include <string>
 
 // ─────────────────────────────────────────────
@@ -33,17 +34,49 @@
 #define ERR_INVALID_ARGUMENTS 1
 #define ERR_SOCKET_NULL 2
 #define ERR_FORCED_SHUTDOWN 3
+#define ERR_CHECK_FAILED 4              // hera_bench / hera_loadgen: a verification case failed
 
 // ─────────────────────────────────────────────
 // Defined values
 // ─────────────────────────────────────────────
 #define NO_VERSION "no_version"
 #define EXPECTED_MESSAGE_LENGTH 13
+#define EXPECTED_RANGE_MESSAGE_LENGTH 29
+#define SELECTION_TRAILER_LENGTH 9      // Optional uint64 object mask + uint8 component mask after a request
+#define MULTI_REQUEST_COMMAND 'M'
+#define MULTI_REQUEST_HEADER_LENGTH 2   // 'M', request count | MULTI_REQUEST_CONCATENATE, then count 13-byte requests
+#define MULTI_REQUEST_MAX 64
+#define MULTI_REQUEST_CONCATENATE 0x80  // Count flag: one reply frame instead of one frame per request
+#define MULTI_REQUEST_MAX_LENGTH (MULTI_REQUEST_HEADER_LENGTH + MULTI_REQUEST_MAX * EXPECTED_MESSAGE_LENGTH)
+
+// ─────────────────────────────────────────────
+// Server options - optional flags after the positional arguments
+// ─────────────────────────────────────────────
+struct ServerOptions {
+    int workers = 0;                // SPICE worker processes, 0 runs SPICE on the compute thread
+    int loops = 1;                  // uWS event loop threads sharing the port
+    double stateCacheTolerance = 0; // Chebyshev state cache position tolerance in km, 0 disables the cache
+    double stateCacheWindow = 3600; // Chebyshev state cache window length in seconds
+    size_t responseCacheEntries = 0;        // Response cache capacity, 0 disables the cache
+    double responseCacheQuantum = 0.001;    // Response cache time quantum in seconds
+    bool responseCacheSnap = false;         // Compute and echo the snapped time instead of the requested one
+    std::string catalogPath;                // Object catalog file, empty uses the built-in object list
+    bool deflate = false;                   // Offer permessage-deflate, used for frames above compressThreshold
+    size_t compressThreshold = 4096;        // Frames below this size in bytes are never compressed
+    int zstdLevel = 3;                      // zstd level of connections that negotiated ENCODING_ZSTD
+    size_t maxBuffered = 65536;             // Unsent bytes per connection above which real-time frames are held back
+    double snapshotSegment = 0;             // Ephemeris snapshot segment length in seconds, 0 disables the snapshot
+    int prefetchDepth = 0;                  // Frames computed ahead of steady request streams, 0 disables prefetch
+    bool metrics = false;                   // Count requests and time their stages, served on /metrics
+    int traceSampling = 0;                  // Trace one in every n requests, 0 disables tracing
+};
+extern ServerOptions serverOptions;
 
 // ─────────────────────────────────────────────
 // Utility functions
 // ─────────────────────────────────────────────
 void loadValues(int argc, char** argv, int& port, int& syncInterval);
+void loadOptions(int argc, char** argv, ServerOptions& options, int firstOption = 3);
 void checkArgc(int argc, char** argv);
 void printUsage(char** argv);
 void printTitle();
@@ -19,20 +19,29 @@
 
 // Standard C++ Libraries
 #include <condition_variable>
+#include <string_view>
+#include <cstdint>
+#include <string>
 #include <queue>
 #include <unordered_set>
+#include <memory>
+#include <vector>
 #include <mutex>
 #include <atomic>
 
 // External Libraries
 #include <uWebSockets/App.h>
 
+// Project Headers
+#include <response_encoding.hpp>
+
 // ─────────────────────────────────────────────
 // Synchronization for Message Waiting
 // ─────────────────────────────────────────────
 extern std::mutex spiceMutex;
 extern std::condition_variable spiceCondition;
 extern std::atomic<bool> spiceDataAvailable;
+extern bool spiceReloading;                     // Guarded by spiceMutex: the data manager reloads the server's kernels
 
 // ─────────────────────────────────────────────
 // Connection ID Allocator
@@ -55,22 +64,55 @@ extern ConnectionIDAllocator idAllocator;
 // ─────────────────────────────────────────────
 struct UserData {
     uint64_t id;
+    uint64_t session;   // Never reused, unlike the id - identifies the socket for deferred responses
+    EncodingState encoding;     // Negotiated response encoding and the previous frame for delta coding
+
+    // Backpressure - real-time responses wait here, newest only, while the socket is above serverOptions.maxBuffered
+    std::string pendingResponse;
+    uint8_t pendingComponents = 0;
+    uWS::OpCode pendingOpCode = uWS::OpCode::BINARY;
+    uint64_t droppedFrames = 0;
 };
 using WS = uWS::WebSocket<false, uWS::SERVER, UserData>;
-extern std::mutex socketMutex;
-extern std::unordered_set<WS*> activeSockets;
+extern std::atomic<uint64_t> nextSession;
+extern std::atomic<uint64_t> droppedFrames;     // Every connection, logged with the kernel version checks
+bool isSocketOpen(WS* ws, uint64_t session);    // Only on the loop thread that owns the socket
+
+// ─────────────────────────────────────────────
+// WebSocket Loops - one uWS::App per thread, all on the same port
+// ─────────────────────────────────────────────
+struct WebSocketLoop {
+    int index;
+    uWS::Loop* loop = nullptr;                  // Set while run() is active, guarded by loopsMutex
+    us_listen_socket_t* listenSocket = nullptr; // Loop thread only
+    std::unordered_set<WS*> sockets;            // Loop thread only
+    std::atomic<int> connections = 0;           // Folded into activeConnections
+};
+extern std::mutex loopsMutex;
+extern std::vector<std::unique_ptr<WebSocketLoop>> webSocketLoops;
+extern bool webSocketLoopsStopping;
+extern thread_local WebSocketLoop* currentLoop;
 
 // ─────────────────────────────────────────────
 // WebSocket Event Handlers
 // ─────────────────────────────────────────────
 void onOpen(WS *ws);
 void onMessage(WS *ws, std::string_view message, uWS::OpCode opCode);
+void onDrain(WS *ws);
 void onClose(WS *ws, int code, std::string_view message);
 
+/*
+ * Answers a request from the prefetched frames, the response cache or the ephemeris snapshot,
+ * or hands it to the compute thread.
+ * Returns true if the response was sent right away.
+ */
+bool dispatchRequest(WS* ws, std::string&& request, uWS::OpCode opCode, uint64_t subscription = 0);
+void sendResponse(WS* ws, std::string_view response, uint8_t components, uWS::OpCode opCode);    // Applies the negotiated encoding
+void sendMultiResponse(WS* ws, std::string_view response, uWS::OpCode opCode);  // One frame, or one corked frame per reply
+
 // ─────────────────────────────────────────────
 // WebSocket Shutdown Control
 // ─────────────────────────────────────────────
-extern us_listen_socket_t* listenSocket;
-void stopWebSocketManagerWorker();
+void stopWebSocketManagerWorker();     // Closes every listen socket and every connection on every loop
 
 #endif // WEBSOCKET_MANAGER_HPP
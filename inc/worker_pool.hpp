@@ -0,0 +1,204 @@
+/*
+ *  Copyright 2025 Mendel Dobondi-Reisz
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef WORKER_POOL_HPP
+#define WORKER_POOL_HPP
+
+// Standard C++ Libraries
+#include <string_view>
+#include <functional>
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <deque>
+
+// System Libraries
+#include <sys/types.h>
+
+// Project Headers
+#include <request_trace.hpp>
+#include <metrics.hpp>
+#include <utils.hpp>
+
+// ─────────────────────────────────────────────
+// Worker Pool Layout
+// ─────────────────────────────────────────────
+#define SPICE_WORKER_FLAG "--spice-worker"     // Hidden argument: the executable was started as a worker
+#define MAX_WORKERS 64
+#define WORKER_RING_CAPACITY 64                 // Slots per ring, must be a power of two
+#define WORKER_REQUEST_SIZE 896                 // Largest request a slot can carry
+#define WORKER_RESPONSE_CHUNK_SIZE 2048         // Response bytes per slot, larger responses span several slots
+
+static_assert((WORKER_RING_CAPACITY & (WORKER_RING_CAPACITY - 1)) == 0, "Ring capacity must be a power of two");
+static_assert(WORKER_REQUEST_SIZE >= MULTI_REQUEST_MAX_LENGTH, "A request slot must fit a full multi-request frame");
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "Rings, metrics and trace rings in shared memory need lock-free 64-bit atomics");
+
+// ─────────────────────────────────────────────
+// SPSC Ring - lock-free, lives in shared memory
+// ─────────────────────────────────────────────
+
+/*
+ * Single producer, single consumer ring of fixed-size slots.
+ * The producer fills back() then calls push(), the consumer reads front() then calls pop().
+ * Zero-filled memory is a valid empty ring, so it can be placed directly into a fresh mapping.
+ */
+template <typename Slot, size_t Capacity>
+class SpscRing {
+public:
+    Slot* back() {
+        uint64_t head = this->head.load(std::memory_order_relaxed);
+        if (head - tail.load(std::memory_order_acquire) == Capacity) return nullptr;
+        return &slots[head & (Capacity - 1)];
+    }
+    void push() { head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+    Slot* front() {
+        uint64_t tail = this->tail.load(std::memory_order_relaxed);
+        if (tail == head.load(std::memory_order_acquire)) return nullptr;
+        return &slots[tail & (Capacity - 1)];
+    }
+    void pop() { tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+    void reset() { head.store(0); tail.store(0); }  // Only when neither side is running
+private:
+    alignas(64) std::atomic<uint64_t> head;     // Next slot to write (producer owned)
+    alignas(64) std::atomic<uint64_t> tail;     // Next slot to read (consumer owned)
+    alignas(64) Slot slots[Capacity];
+};
+
+struct RequestSlot {
+    uint64_t tag;
+    uint64_t trace;                             // Sampled trace id, 0 if the request is not traced
+    uint64_t submittedAt;                       // steadyNanoseconds() of traced requests
+    uint32_t length;
+    char data[WORKER_REQUEST_SIZE];
+};
+
+struct ResponseSlot {
+    uint64_t tag;
+    uint32_t length;
+    uint32_t last;                              // 1 on the final chunk of a response
+    char data[WORKER_RESPONSE_CHUNK_SIZE];
+};
+
+// ─────────────────────────────────────────────
+// Shared Memory Control Block
+// ─────────────────────────────────────────────
+enum class WorkerState : uint32_t {
+    EMPTY,      // Not spawned
+    LOADING,    // Running, kernels not loaded
+    READY,      // Running, kernels loaded - accepts requests
+    EXITED      // Left its main loop
+};
+
+struct alignas(64) WorkerSlot {
+    std::atomic<WorkerState> state;
+    std::atomic<pid_t> pid;
+    std::atomic<uint64_t> loadedGeneration;     // Kernel generation loaded by the worker, 0 if none
+    std::atomic<uint32_t> retire;               // 1: answer the queued requests, then exit
+    ThreadMetrics metrics;                      // Written by the worker, kept across respawns
+    SpscRing<RequestSlot, WORKER_RING_CAPACITY> requests;      // Server -> worker
+    SpscRing<ResponseSlot, WORKER_RING_CAPACITY> responses;    // Worker -> server
+};
+
+struct alignas(64) WorkerPoolControl {
+    std::atomic<bool> shouldRun;
+    std::atomic<bool> kernelsAvailable;
+    std::atomic<uint64_t> kernelGeneration;     // Bumped every time a kernel version becomes available
+    std::atomic<uint32_t> activeBank;           // Bank that takes new requests, the other one loads or drains
+    uint32_t workerCount;                       // Workers per bank
+    uint32_t traceRings;                        // 1: a TraceRing per worker slot follows the slots (--trace)
+};
+
+// ─────────────────────────────────────────────
+// Worker Pool - owned by the server process
+// ─────────────────────────────────────────────
+class WorkerPool {
+public:
+    WorkerPool(int workerCount, std::vector<std::string> workerOptions = {});
+    ~WorkerPool();
+
+    bool start();                               // Create the shared memory and spawn the workers
+    void stop();                                // Stop the workers and remove the shared memory
+    int size() const;
+    int readyWorkers() const;
+
+    // Dispatching (single dispatcher thread only)
+    bool submit(uint64_t tag, std::string_view request, uint64_t trace = 0);   // false if no ready worker has a free slot
+    size_t poll(const std::function<void(uint64_t, std::string&&)>& onResponse);
+    void superviseWorkers(std::vector<uint64_t>& lostTags); // Respawns crashed workers, returns their unanswered tags
+
+    // Metrics (any thread): the blocks of both banks, every worker that ever ran
+    void forEachWorkerMetrics(const std::function<void(const ThreadMetrics&)>& visit) const;
+    void forEachWorkerTrace(const std::function<void(const TraceRing&)>& visit) const;
+
+    // Kernel availability (data manager thread)
+    void publishKernels();                      // A new kernel version is loadable, workers (re)load it
+    void withdrawKernels();                     // Workers unload their kernels, returns once all did
+
+    /*
+     * Hot swap (data manager thread): a fresh bank of workers loads the kernels now on disk
+     * while the active bank keeps serving. Once all of them are ready new requests go to
+     * the new bank, and the old one answers what it has queued and exits.
+     * Returns false, with the old bank still active, if the new bank failed to load.
+     */
+    bool swapKernels();
+private:
+    std::string shmName;
+    std::vector<std::string> workerOptions;     // Server options forwarded to every worker
+    int workerCount;
+    size_t mappedSize;
+    WorkerPoolControl* control;
+
+    std::vector<std::deque<uint64_t>> inFlight; // Tags per worker, in the order the worker answers them
+    std::vector<std::string> partial;           // Response being reassembled per worker
+    std::chrono::steady_clock::time_point lastSupervision;
+
+    WorkerSlot* worker(int index) const;        // Slots of bank b are b * workerCount ... b * workerCount + workerCount - 1
+    int activeBank() const;
+    bool spawnWorker(int index, bool resetRings = true);
+    void retireBank(int bank);
+};
+
+// ─────────────────────────────────────────────
+// Worker Process - entry point and helpers
+// ─────────────────────────────────────────────
+size_t workerPoolMappingSize(int workerCount, bool traceRings);    // Control block, two banks of worker slots, their trace rings
+WorkerSlot* workerSlot(WorkerPoolControl* control, int index);
+TraceRing* workerTraceRing(WorkerPoolControl* control, int index);  // nullptr without --trace
+void pollBackoff(int idleRounds);               // Spin, then yield, then sleep while a ring stays empty
+bool isSpiceWorkerInvocation(int argc, char** argv);
+int runSpiceWorker(int argc, char** argv);
+
+// ─────────────────────────────────────────────
+// Worker Pool Instance - nullptr when SPICE runs in-process
+// ─────────────────────────────────────────────
+extern WorkerPool* workerPool;
+bool startWorkerPool(int workerCount, std::vector<std::string> workerOptions);
+void stopWorkerPool();
+
+// ─────────────────────────────────────────────
+// Swap Worker - answers for the compute thread while it reloads, without --workers
+// ─────────────────────────────────────────────
+extern std::vector<std::string> workerProcessOptions;  // Server options forwarded to worker processes
+bool startSwapWorker();                         // Data manager: one worker loads the kernels on disk, true once it is ready
+bool answerOnSwapWorker(std::string_view request, uint64_t trace, std::string& response);  // Compute thread, false if it must wait
+void stopSwapWorker();                          // Data manager, once the compute thread has its own kernels again
+
+#endif // WORKER_POOL_HPP
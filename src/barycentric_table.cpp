@@ -0,0 +1,117 @@
+/*
+ *  Copyright 2025 Mendel Dobondi-Reisz
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+// C++ Standard Libraries
+#include <cstdint>
+#include <vector>
+
+// External Libraries
+#include <cspice/SpiceUsr.h>
+
+// Project Headers
+#include <barycentric_table.hpp>
+#include <object_catalog.hpp>
+
+
+
+// ─────────────────────────────────────────────
+// Barycentric Table - SSB states of one epoch
+// ─────────────────────────────────────────────
+
+bool barycentricState(SpiceInt id, SpiceDouble et, SpiceDouble state[6]) {
+    if (id == 0) {
+        for (int i = 0; i < 6; i++) state[i] = 0.0;
+        return true;
+    }
+
+    spkssb_c(id, et, "J2000", state);
+    if (failed_c()) { reset_c(); return false; }
+    return true;
+}
+
+void BarycentricTable::prepare(SpiceDouble et, uint64_t objectMask) {
+    if (!valid || et != this->et || objects.size() != objectCatalog.size()) {
+        this->et = et;
+        valid = true;
+        loadedMask = 0;
+        objects.assign(objectCatalog.size(), BarycentricState{ {}, false });
+        observers.clear();
+    }
+
+    for (const CatalogObject& object : objectCatalog) {
+        uint64_t bit = uint64_t(1) << object.index;
+        if (!(objectMask & bit) || (loadedMask & bit)) continue;
+
+        if (object.hasEphemeris) objects[object.index].available = barycentricState(object.id, et, objects[object.index].state);
+        loadedMask |= bit;
+    }
+}
+
+const BarycentricState& BarycentricTable::observerState(SpiceInt observerId) {
+    for (const auto& [id, state] : observers) {
+        if (id == observerId) return state;
+    }
+
+    // Observers in the catalog were already looked up with the objects
+    const CatalogObject* object = findCatalogObject(observerId);
+    if (object && (loadedMask >> object->index & 1)) {
+        observers.emplace_back(observerId, objects[object->index]);
+        return observers.back().second;
+    }
+
+    BarycentricState state;
+    state.available = barycentricState(observerId, et, state.state);
+    observers.emplace_back(observerId, state);
+    return observers.back().second;
+}
+
+bool BarycentricTable::relativeState(const CatalogObject& object, SpiceInt observerId, SpiceDouble state[6]) {
+    if (!valid || !(loadedMask >> object.index & 1)) return false;
+
+    const BarycentricState& target = objects[object.index];
+    const BarycentricState& observer = observerState(observerId);
+    if (!target.available || !observer.available) return false;
+
+    for (int i = 0; i < 6; i++) state[i] = target.state[i] - observer.state[i];
+    return true;
+}
+
+const BarycentricState* BarycentricTable::objectState(const CatalogObject& object) const {
+    if (!valid || !(loadedMask >> object.index & 1)) return nullptr;
+    return &objects[object.index];
+}
+
+SpiceDouble BarycentricTable::epoch() const {
+    return et;
+}
+
+void BarycentricTable::invalidate() {
+    valid = false;
+    objects.clear();
+    observers.clear();
+}
+
+
+
+// ─────────────────────────────────────────────
+// Barycentric Table Instance
+// ─────────────────────────────────────────────
+
+BarycentricTable barycentricTable;
+
+void invalidateBarycentricTable() {
+    barycentricTable.invalidate();
+}
@@ -0,0 +1,226 @@
+/*
+ *  Copyright 2025 Mendel Dobondi-Reisz
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+// C++ Standard Libraries
+#include <condition_variable>
+#include <unordered_map>
+#include <iostream>
+#include <cstdint>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <deque>
+
+// External Libraries
+#include <uWebSockets/App.h>
+
+// Project Headers
+#include <websocket_manager.hpp>
+#include <compute_manager.hpp>
+#include <response_cache.hpp>
+#include <response_encoding.hpp>
+#include <subscription_manager.hpp>
+#include <prefetch_manager.hpp>
+#include <worker_pool.hpp>
+#include <spice_core.hpp>
+#include <request_trace.hpp>
+#include <metrics.hpp>
+#include <utils.hpp>
+
+
+
+// ─────────────────────────────────────────────
+// Compute Queue - event loop -> compute thread
+// ─────────────────────────────────────────────
+
+std::mutex computeMutex;
+std::condition_variable computeCondition;
+std::deque<ComputeTask> computeQueue;
+std::deque<ComputeTask> prefetchQueue;
+std::unordered_map<std::string, InFlightRequest> inFlightRequests;
+static std::atomic<uint64_t> submittedRequests = 0;
+static std::atomic<uint64_t> coalescedRequests = 0;
+static std::atomic<size_t> workerBacklog = 0;  // Published by the worker pool dispatcher
+
+void submitComputeTask(ComputeTask&& task) {
+    task.trace = currentTrace();                // Set while the loop handles a sampled request
+    task.queuedAt = isMetricsEnabled() || task.trace ? steadyNanoseconds() : 0;
+    {
+        std::lock_guard<std::mutex> lock(computeMutex);
+        submittedRequests.fetch_add(1, std::memory_order_relaxed);
+
+        // The same bytes give the same response: join the computation already queued or running
+        auto [it, inserted] = inFlightRequests.try_emplace(task.request, InFlightRequest{ task.cacheGeneration, {} });
+        if (!inserted && it->second.generation == task.cacheGeneration) {
+            it->second.followers.push_back(std::move(task));
+            coalescedRequests.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        task.shared = inserted;                 // Requests from before a kernel swap do not answer later ones
+        computeQueue.push_back(std::move(task));
+    }
+    computeCondition.notify_one();
+}
+
+bool submitPrefetchTask(ComputeTask&& task) {
+    {
+        std::lock_guard<std::mutex> lock(computeMutex);
+        // With workers, computeQueue is drained into the dispatcher right away and says nothing about load
+        size_t waiting = workerPool ? workerBacklog.load(std::memory_order_relaxed) : computeQueue.size();
+        if (waiting > 0 || prefetchQueue.size() >= PREFETCH_QUEUE_LIMIT) return false;
+        task.queuedAt = stageStart();
+        prefetchQueue.push_back(std::move(task));
+    }
+    computeCondition.notify_one();
+    return true;
+}
+
+bool waitForComputeTask(ComputeTask& task) {
+    std::unique_lock<std::mutex> lock(computeMutex);
+    computeCondition.wait(lock, [] {
+        return !computeQueue.empty() || !prefetchQueue.empty() || !shouldComputeManagerRun.load();
+    });
+
+    if (!shouldComputeManagerRun.load()) return false;
+
+    // Client requests first, prefetch only uses what they leave idle
+    std::deque<ComputeTask>& queue = computeQueue.empty() ? prefetchQueue : computeQueue;
+    task = std::move(queue.front());
+    queue.pop_front();
+    return true;
+}
+
+void takeComputeTasks(std::deque<ComputeTask>& backlog) {
+    std::lock_guard<std::mutex> lock(computeMutex);
+    while (!computeQueue.empty()) {
+        backlog.push_back(std::move(computeQueue.front()));
+        computeQueue.pop_front();
+    }
+}
+
+void publishWorkerBacklog(size_t waiting) {
+    workerBacklog.store(waiting, std::memory_order_relaxed);
+}
+
+bool takePrefetchTask(ComputeTask& task) {
+    std::lock_guard<std::mutex> lock(computeMutex);
+    if (prefetchQueue.empty()) return false;
+
+    task = std::move(prefetchQueue.front());
+    prefetchQueue.pop_front();
+    return true;
+}
+
+
+
+// ─────────────────────────────────────────────
+// Single-Flight Coalescing - identical requests share one computation
+// ─────────────────────────────────────────────
+
+CoalescingStats coalescingStats() {
+    return { submittedRequests.load(), coalescedRequests.load() };
+}
+
+
+
+// ─────────────────────────────────────────────
+// Response Delivery - compute thread -> event loop
+// ─────────────────────────────────────────────
+
+static void postResponse(const ComputeTask& task, std::string&& response) {
+    if (task.prefetch) {
+        task.loop->defer([ws = task.ws, session = task.session, request = task.request, generation = task.cacheGeneration,
+                          response = std::move(response)]() mutable {
+            if (isSocketOpen(ws, session)) completePrefetch(ws, request, std::move(response), generation);
+        });
+        return;
+    }
+
+    WS* ws = task.ws;
+    uint64_t session = task.session;
+    uWS::OpCode opCode = task.opCode;
+    uint64_t subscription = task.subscription;
+    uint8_t components = requestComponents(task.request);
+    bool multi = isMultiRequest(task.request);
+    bool stream = !subscription && isPrefetchEnabled() && isPrefetchableRequest(task.request);
+    uint64_t trace = task.trace;
+    uint64_t postedAt = trace ? steadyNanoseconds() : 0;
+
+    task.loop->defer([ws, session, opCode, subscription, components, multi, stream, trace, postedAt,
+                      response = std::move(response)]() {
+        if (!isSocketOpen(ws, session)) return;     // Client left while the request was computed
+        if (subscription && !completeSubscriptionFrame(ws, subscription)) return;   // Unsubscribed in the meantime
+
+        setCurrentTrace(trace);
+        traceStage(TraceStage::LOOP_WAIT, postedAt);
+        if (multi) sendMultiResponse(ws, response, opCode);
+        else sendResponse(ws, response, components, opCode);
+        traceInstant(TraceStage::REQUEST_END);
+        setCurrentTrace(0);
+        if (stream) schedulePrefetch(ws, opCode);              // The client's own request no longer holds the backend
+
+        #ifdef DEBUG
+            if (!multi) printResponse(response);
+        #endif
+    });
+}
+
+void deliverResponse(const ComputeTask& task, std::string&& response) {
+    if (isResponseCacheEnabled()) responseCache.insert(task.request, response, task.cacheGeneration);
+
+    if (task.shared) {
+        std::vector<ComputeTask> followers;
+        {
+            std::lock_guard<std::mutex> lock(computeMutex);
+            auto it = inFlightRequests.find(task.request);
+            if (it != inFlightRequests.end()) {
+                followers = std::move(it->second.followers);
+                inFlightRequests.erase(it);
+            }
+        }
+        for (const ComputeTask& follower : followers) postResponse(follower, std::string(response));
+    }
+
+    postResponse(task, std::move(response));
+}
+
+
+
+// ─────────────────────────────────────────────
+// ComputeManager Shutdown Control
+// ─────────────────────────────────────────────
+
+std::atomic<bool> shouldComputeManagerRun = true;
+
+void stopComputeManagerWorker() {
+    {
+        std::lock_guard<std::mutex> lock(computeMutex);
+        shouldComputeManagerRun.store(false);
+        computeQueue.clear();
+        prefetchQueue.clear();
+        inFlightRequests.clear();
+        workerBacklog.store(0, std::memory_order_relaxed);
+    }
+    computeCondition.notify_all();
+
+    {
+        std::lock_guard<std::mutex> lock(spiceMutex);       // Wake the worker if it waits for SPICE data
+    }
+    spiceCondition.notify_all();
+
+    std::cout << color("log") << "ComputeManager shutdown requested.\n" << std::flush;
+}
@@ -22,6 +22,7 @@
 #include <cstring>
 #include <vector>
 #include <array>
+#include <cctype>
 
 // System Libraries
 #ifdef __linux__
@@ -38,7 +39,12 @@
 // Project Headers
 #include <websocket_manager.hpp>
 #include <data_manager.hpp>
+#include <worker_pool.hpp>
+#include <response_cache.hpp>
+#include <ephemeris_snapshot.hpp>
+#include <state_cache.hpp>
 #include <spice_core.hpp>
+#include <metrics.hpp>
 #include <utils.hpp>
 
 
@@ -409,7 +415,8 @@ std::string DataManager::getRemoteVersion() {
 
 bool DataManager::isNewVersionAvailable() {
     std::string localVersion = getLocalVersion();
-    std::string remoteVersion = getRemoteVersion();
+    remoteVersion = getRemoteVersion();
+    if (!remoteVersion.empty()) recordKernelSync();
     if (localVersion == remoteVersion) {
         std::cout << color("log") << "No new kernel version available.\nLocal kernel version:  " << localVersion << "\n\n";
         return false;
@@ -429,7 +436,8 @@ bool DataManager::unzipZipFile() {
 }
 
 bool DataManager::editTempMetaKernelFiles() {
-    return updateMetaKernelPaths(temporaryMetaKernelDirectory, kernelDirectory);    
+    // Versioned path, not data/hera: loaded kernels keep resolving while data/hera moves on
+    return updateMetaKernelPaths(temporaryMetaKernelDirectory, versionDirectory(remoteVersion) / "kernels");
 }
 
 bool DataManager::editTempVersionFile() {
@@ -438,14 +446,90 @@ bool DataManager::editTempVersionFile() {
         std::cerr << color("error") << "No version file found." << std::endl;
         return false;
     }
-    versionFile << getRemoteVersion();
+    versionFile << remoteVersion;
     versionFile.close();
     std::cout << color("log") << "Updated temporary version file.\n";
     return true;
 }
 
+std::filesystem::path DataManager::versionDirectory(const std::string& version) const {
+    std::string name = "hera.";
+    for (char c : version) name += (std::isalnum(static_cast<unsigned char>(c)) || c == '-' || c == '.') ? c : '_';
+    return dataDirectory / name;
+}
+
 bool DataManager::moveFolder() {
-    return replaceDirectory(temporaryHeraDirectory, heraDirectory);
+    std::filesystem::path target = versionDirectory(remoteVersion);
+    if (!replaceDirectory(temporaryHeraDirectory, target)) return false;
+
+    std::error_code ec;
+    retiredHeraDirectory.clear();
+    retiredFromPlainDirectory = false;
+
+    if (std::filesystem::is_symlink(heraDirectory, ec)) {
+        retiredHeraDirectory = dataDirectory / std::filesystem::read_symlink(heraDirectory, ec).filename();
+    }
+    else if (std::filesystem::exists(heraDirectory, ec)) {
+        // Older layout: data/hera is the kernel directory itself, keep it aside until it is unloaded
+        retiredHeraDirectory = dataDirectory / "hera.previous";
+        retiredFromPlainDirectory = true;
+        std::filesystem::remove_all(retiredHeraDirectory, ec);
+        std::filesystem::rename(heraDirectory, retiredHeraDirectory, ec);
+        if (ec) {
+            std::cerr << color("error") << "Error moving " << heraDirectory << " aside: " << ec.message() << std::endl;
+            return false;
+        }
+    }
+    if (retiredHeraDirectory == target) retiredHeraDirectory.clear();
+
+    return pointHeraDirectoryAt(target);
+}
+
+bool DataManager::pointHeraDirectoryAt(const std::filesystem::path& target) {
+    // New link next to the old one, then rename over it: data/hera always resolves
+    std::error_code ec;
+    std::filesystem::path link = dataDirectory / "hera.link";
+    std::filesystem::remove(link, ec);
+    std::filesystem::create_directory_symlink(target.filename(), link, ec);
+    if (!ec) std::filesystem::rename(link, heraDirectory, ec);
+    if (ec) {
+        std::cerr << color("error") << "Error pointing " << heraDirectory << " at " << target << ": " << ec.message() << std::endl;
+        return false;
+    }
+    std::cout << color("log") << "Active kernels: " << target << "\n";
+    return true;
+}
+
+bool DataManager::restorePreviousVersion() {
+    if (retiredHeraDirectory.empty()) return false;
+
+    std::error_code ec;
+    std::filesystem::path failed = versionDirectory(remoteVersion);
+    bool restored;
+    if (retiredFromPlainDirectory) {
+        std::filesystem::remove(heraDirectory, ec);
+        std::filesystem::rename(retiredHeraDirectory, heraDirectory, ec);
+        restored = !ec;
+    }
+    else restored = pointHeraDirectoryAt(retiredHeraDirectory);
+
+    if (restored) std::filesystem::remove_all(failed, ec);          // Downloaded again on the next check
+    retiredHeraDirectory.clear();
+    return restored;
+}
+
+bool DataManager::deleteRetiredVersion() {
+    if (retiredHeraDirectory.empty()) return true;
+
+    std::error_code ec;
+    std::filesystem::remove_all(retiredHeraDirectory, ec);
+    if (ec) {
+        std::cerr << color("error") << "Error deleting " << retiredHeraDirectory << ": " << ec.message() << std::endl;
+        return false;
+    }
+    std::cout << color("log") << "Deleted: " << retiredHeraDirectory << std::endl;
+    retiredHeraDirectory.clear();
+    return true;
 }
 
 bool DataManager::deleteTmpFolder() {
@@ -483,16 +567,80 @@ bool DataManager::deleteUnUsedFiles() {
     return success;
 }
 
+// Fits and responses of the previous kernel version are stale
+static void invalidateKernelCaches() {
+    invalidateStateCache();
+    flushResponseCache();
+}
+
 void DataManager::makeSpiceDataAvailable() {
     initSpiceCore();
+    invalidateKernelCaches();
     signalSpiceDataAvailable();
+    if (workerPool) workerPool->publishKernels();   // Worker processes load the new kernels themselves
+    recordKernelSwap(getLocalVersion());
 }
 
 void DataManager::makeSpiceDataUnavailable() {
+    unloadEphemerisSnapshot();
+    if (workerPool) workerPool->withdrawKernels();  // Returns once no worker holds the old kernels
     signalSpiceDataUnavailable();
     deinitSpiceCore();
 }
 
+bool DataManager::swapSpiceData() {
+    if (!spiceDataAvailable.load()) {               // Nothing loaded yet, nothing to keep serving
+        makeSpiceDataAvailable();
+        return true;
+    }
+
+    unloadEphemerisSnapshot();                      // Describes the old version, the compute path answers until the new one
+
+    // Worker processes: a new bank loads the new version while the current one serves
+    if (workerPool && !workerPool->swapKernels()) return false;
+
+    // In-process computation: a swap worker answers with the new version while the server's kernels reload
+    bool bridged = !workerPool && startSwapWorker();
+    if (!workerPool && !bridged) {
+        std::cerr << color("warn") << "No swap worker, requests wait for the kernel reload.\n" << std::flush;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(spiceMutex);   // After the request being computed
+        spiceReloading = true;
+        invalidateKernelCaches();                   // Nothing answers from the old version from here on
+    }
+
+    // The compute thread stays out of CSPICE while spiceReloading is set
+    deinitSpiceCore();
+    initSpiceCore();
+
+    {
+        std::lock_guard<std::mutex> lock(spiceMutex);
+        spiceReloading = false;
+    }
+    spiceCondition.notify_all();
+    if (bridged) stopSwapWorker();                  // After the request it may still be answering
+    recordKernelSwap(getLocalVersion());
+    return true;
+}
+
+void DataManager::makeEphemerisSnapshotAvailable() {
+    if (!isEphemerisSnapshotEnabled()) return;
+
+    // Lives in the version directory: replaced and deleted together with the kernels it was computed from
+    std::filesystem::path snapshotFile = heraDirectory / SNAPSHOT_FILE_NAME;
+    std::string version = getLocalVersion();
+    if (loadEphemerisSnapshot(snapshotFile, version)) {
+        std::cout << color("log") << "Ephemeris snapshot loaded: " << snapshotFile << "\n\n" << std::flush;
+        return;
+    }
+
+    if (!writeEphemerisSnapshot(snapshotFile, version) || !loadEphemerisSnapshot(snapshotFile, version)) {
+        std::cerr << color("warn") << "No ephemeris snapshot, 'i' requests are computed with SPICE.\n\n" << std::flush;
+    }
+}
+
 
 
 // ─────────────────────────────────────────────
@@ -0,0 +1,373 @@
+/*
+ *  Copyright 2025 Mendel Dobondi-Reisz
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+// C++ Standard Libraries
+#include <string_view>
+#include <filesystem>
+#include <algorithm>
+#include <iostream>
+#include <fstream>
+#include <cstring>
+#include <cstdint>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <mutex>
+
+// System Libraries
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+// External Libraries
+#include <cspice/SpiceUsr.h>
+
+// Project Headers
+#include <ephemeris_snapshot.hpp>
+#include <websocket_manager.hpp>
+#include <data_manager.hpp>
+#include <state_cache.hpp>
+#include <spice_core.hpp>
+#include <utils.hpp>
+
+#define SNAPSHOT_FLAGS_SERVED (SNAPSHOT_EPHEMERIS | SNAPSHOT_ORIENTATION)  // Objects that appear in responses
+#define SNAPSHOT_SPAN_MARGIN 60.0       // Seconds: the span in ET also holds the leap seconds inserted during it
+
+// --snapshot, lengthened to the shortest whole-second segment that keeps the catalog within SNAPSHOT_MAX_BYTES
+static double snapshotSegmentLength() {
+    uint64_t bytesPerSegment = std::max<uint64_t>(objectCatalog.size(), 1) * sizeof(SnapshotRecord);
+    uint64_t maxSegments = (SNAPSHOT_MAX_BYTES - sizeof(SnapshotHeader)) / bytesPerSegment;
+    double minimum = std::ceil((SNAPSHOT_END_UTC - SNAPSHOT_START_UTC + SNAPSHOT_SPAN_MARGIN) / maxSegments);
+    return std::max(serverOptions.snapshotSegment, minimum);
+}
+
+
+
+// ─────────────────────────────────────────────
+// Ephemeris Snapshot - read-only mapping of one snapshot file
+// ─────────────────────────────────────────────
+
+EphemerisSnapshot::~EphemerisSnapshot() {
+    if (mapping) munmap(mapping, mappingSize);
+}
+
+bool EphemerisSnapshot::map(const std::filesystem::path& path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(SnapshotHeader)) {
+        close(fd);
+        return false;
+    }
+
+    // Shared and read-only: every loop thread and process reads the same page cache
+    void* pages = mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (pages == MAP_FAILED) return false;
+    mapping = pages;
+    mappingSize = info.st_size;
+
+    const SnapshotHeader* candidate = static_cast<const SnapshotHeader*>(mapping);
+    if (std::memcmp(candidate->magic, SNAPSHOT_MAGIC, sizeof(candidate->magic)) != 0) return false;
+    if (candidate->formatVersion != SNAPSHOT_FORMAT_VERSION || candidate->degree != STATE_CACHE_DEGREE) return false;
+    if (candidate->recordSize != sizeof(SnapshotRecord) || candidate->objectCount > MAX_CATALOG_OBJECTS) return false;
+    if (candidate->leapSecondCount == 0 || candidate->leapSecondCount > SNAPSHOT_MAX_LEAP_SECONDS) return false;
+    if (!(candidate->segmentLength > 0.0)) return false;
+    if (mappingSize != sizeof(SnapshotHeader) + candidate->segmentCount * candidate->objectCount * sizeof(SnapshotRecord)) return false;
+
+    header = candidate;
+    records = reinterpret_cast<const SnapshotRecord*>(static_cast<const char*>(mapping) + sizeof(SnapshotHeader));
+
+    leapSeconds.deltaTA = header->deltaTA;
+    leapSeconds.k = header->k;
+    leapSeconds.eb = header->eb;
+    leapSeconds.m[0] = header->m[0];
+    leapSeconds.m[1] = header->m[1];
+    for (uint32_t i = 0; i < header->leapSecondCount; i++) {
+        leapSeconds.deltaAt.emplace_back(header->leapSeconds[i][0], header->leapSeconds[i][1]);
+    }
+    leapSeconds.loaded = true;
+    return true;
+}
+
+bool EphemerisSnapshot::matches(const std::string& kernelVersion) const {
+    if (!header) return false;
+    if (std::string(header->kernelVersion, strnlen(header->kernelVersion, SNAPSHOT_VERSION_LENGTH)) != kernelVersion) return false;
+    if (header->segmentLength != snapshotSegmentLength() || header->tolerance != SNAPSHOT_TOLERANCE) return false;
+
+    // A catalog file edited since the snapshot was written changes the serialization order
+    if (header->objectCount != objectCatalog.size()) return false;
+    for (const CatalogObject& object : objectCatalog) {
+        uint8_t flags = (object.hasEphemeris ? SNAPSHOT_EPHEMERIS : 0) | (object.hasOrientation ? SNAPSHOT_ORIENTATION : 0);
+        if (header->objectIds[object.index] != object.id || header->objectFlags[object.index] != flags) return false;
+    }
+    return true;
+}
+
+const SnapshotRecord* EphemerisSnapshot::record(SpiceDouble et, size_t index, SpiceDouble& x) const {
+    if (index >= header->objectCount) return nullptr;
+
+    SpiceDouble offset = (et - header->start) / header->segmentLength;
+    if (!(offset >= 0.0) || offset >= static_cast<SpiceDouble>(header->segmentCount)) return nullptr;
+
+    uint64_t segment = static_cast<uint64_t>(offset);
+    x = 2.0 * (offset - segment) - 1.0;
+    return &records[segment * header->objectCount + index];
+}
+
+bool EphemerisSnapshot::observerState(SpiceDouble et, SpiceInt observerId, MotionState& state) const {
+    state = {};
+    if (observerId == 0) return true;                       // Every record is relative to the SSB already
+
+    for (size_t i = 0; i < header->objectCount; i++) {
+        if (header->objectIds[i] != observerId) continue;
+
+        SpiceDouble x;
+        const SnapshotRecord* observer = record(et, i, x);
+        if (!observer || !observer->valid) return false;
+        evaluateStateSegment(observer->coefficients, x, state);
+        return true;
+    }
+    return false;                                           // Not in the catalog, the compute thread asks SPICE
+}
+
+static void relativeTo(const MotionState& observer, MotionState& state) {
+    state.position = { state.position.x - observer.position.x, state.position.y - observer.position.y,
+                       state.position.z - observer.position.z };
+    state.velocity = { state.velocity.x - observer.velocity.x, state.velocity.y - observer.velocity.y,
+                       state.velocity.z - observer.velocity.z };
+}
+
+bool EphemerisSnapshot::relativeState(SpiceDouble et, size_t index, SpiceInt observerId, MotionState& state) const {
+    SpiceDouble x;
+    MotionState observer;
+    const SnapshotRecord* object = record(et, index, x);
+    if (!object || !object->valid || !observerState(et, observerId, observer)) return false;
+
+    evaluateStateSegment(object->coefficients, x, state);
+    relativeTo(observer, state);
+    return true;
+}
+
+static void appendObject(std::string& response, SpiceInt objectId, const MotionState& state, uint8_t components) {
+    response.append(reinterpret_cast<const char*>(&objectId), sizeof(objectId));
+    if (components & COMPONENT_POSITION) response.append(reinterpret_cast<const char*>(&state.position), sizeof(state.position));
+    if (components & COMPONENT_VELOCITY) response.append(reinterpret_cast<const char*>(&state.velocity), sizeof(state.velocity));
+    if (components & COMPONENT_ORIENTATION) response.append(reinterpret_cast<const char*>(&state.orientation), sizeof(state.orientation));
+    if (components & COMPONENT_ANGULAR_VELOCITY)
+        response.append(reinterpret_cast<const char*>(&state.angularVelocity), sizeof(state.angularVelocity));
+}
+
+bool EphemerisSnapshot::answer(std::string_view request, std::string& response) const {
+    if (request.size() != EXPECTED_MESSAGE_LENGTH && request.size() != EXPECTED_MESSAGE_LENGTH + SELECTION_TRAILER_LENGTH) return false;
+
+    SpiceDouble timestamp;
+    SpiceInt observerId;
+    uint8_t modeByte = static_cast<uint8_t>(request[sizeof(timestamp)]);
+    std::memcpy(&timestamp, request.data(), sizeof(timestamp));
+    std::memcpy(&observerId, request.data() + sizeof(timestamp) + sizeof(modeByte), sizeof(observerId));
+    if ((modeByte & ~MESSAGE_FLAG_TDB) != static_cast<uint8_t>(MessageMode::ALL_INSTANTANEOUS)) return false;
+    if (!std::isfinite(timestamp)) return false;
+
+    // Invalid selections are answered with the error frame of the compute path
+    uint64_t objectMask = ~uint64_t(0);
+    uint8_t componentMask = COMPONENT_ALL;
+    if (request.size() == EXPECTED_MESSAGE_LENGTH + SELECTION_TRAILER_LENGTH) {
+        std::memcpy(&objectMask, request.data() + EXPECTED_MESSAGE_LENGTH, sizeof(objectMask));
+        std::memcpy(&componentMask, request.data() + EXPECTED_MESSAGE_LENGTH + sizeof(objectMask), sizeof(componentMask));
+        if (objectMask == 0 || componentMask == 0 || (componentMask & ~COMPONENT_ALL)) return false;
+    }
+
+    SpiceDouble et = (modeByte & MESSAGE_FLAG_TDB) ? timestamp : etTimeFromTable(timestamp, leapSeconds);
+    MotionState observer;
+    if (!observerState(et, observerId, observer)) return false;
+
+    response.assign(request.data(), sizeof(timestamp) + sizeof(modeByte));     // Timestamp and mode are echoed
+    size_t objectCount = 0;
+    for (size_t i = 0; i < header->objectCount; i++) {
+        if (!(objectMask >> i & 1)) continue;
+        if ((header->objectFlags[i] & SNAPSHOT_FLAGS_SERVED) != SNAPSHOT_FLAGS_SERVED) continue;   // Left out, as by ObjectData
+
+        SpiceDouble x;
+        const SnapshotRecord* object = record(et, i, x);
+        if (!object || !object->valid) return false;
+
+        MotionState state;
+        evaluateStateSegment(object->coefficients, x, state);
+        relativeTo(observer, state);
+        appendObject(response, header->objectIds[i], state, componentMask);
+        objectCount++;
+    }
+    return objectCount > 0;
+}
+
+
+
+// ─────────────────────────────────────────────
+// Snapshot Writer - data manager thread, kernels loaded
+// ─────────────────────────────────────────────
+
+static bool fillHeader(SnapshotHeader& header, const std::string& kernelVersion) {
+    if (!leapSeconds.loaded || leapSeconds.deltaAt.size() > SNAPSHOT_MAX_LEAP_SECONDS) return false;
+    if (kernelVersion.size() >= SNAPSHOT_VERSION_LENGTH) return false;
+
+    std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.formatVersion = SNAPSHOT_FORMAT_VERSION;
+    header.degree = STATE_CACHE_DEGREE;
+    header.recordSize = sizeof(SnapshotRecord);
+    header.objectCount = static_cast<uint32_t>(objectCatalog.size());
+    header.segmentLength = snapshotSegmentLength();
+    header.tolerance = SNAPSHOT_TOLERANCE;
+    std::memcpy(header.kernelVersion, kernelVersion.data(), kernelVersion.size());
+
+    header.start = etTime(SNAPSHOT_START_UTC);
+    header.segmentCount = static_cast<uint64_t>(std::ceil((etTime(SNAPSHOT_END_UTC) - header.start) / header.segmentLength));
+
+    header.deltaTA = leapSeconds.deltaTA;
+    header.k = leapSeconds.k;
+    header.eb = leapSeconds.eb;
+    header.m[0] = leapSeconds.m[0];
+    header.m[1] = leapSeconds.m[1];
+    header.leapSecondCount = static_cast<uint32_t>(leapSeconds.deltaAt.size());
+    for (size_t i = 0; i < leapSeconds.deltaAt.size(); i++) {
+        header.leapSeconds[i][0] = leapSeconds.deltaAt[i].first;
+        header.leapSeconds[i][1] = leapSeconds.deltaAt[i].second;
+    }
+
+    for (const CatalogObject& object : objectCatalog) {
+        header.objectIds[object.index] = object.id;
+        header.objectFlags[object.index] = (object.hasEphemeris ? SNAPSHOT_EPHEMERIS : 0) |
+                                           (object.hasOrientation ? SNAPSHOT_ORIENTATION : 0);
+    }
+    return true;
+}
+
+bool writeEphemerisSnapshot(const std::filesystem::path& path, const std::string& kernelVersion) {
+    auto start = std::chrono::steady_clock::now();
+
+    SnapshotHeader header = {};
+    if (!fillHeader(header, kernelVersion)) return false;
+
+    if (header.segmentLength != serverOptions.snapshotSegment) {
+        std::cerr << color("warn") << "Ephemeris snapshot segments lengthened to " << header.segmentLength << " s to stay within "
+                  << SNAPSHOT_MAX_BYTES / (1024 * 1024) << " MiB for " << header.objectCount << " objects.\n" << std::flush;
+    }
+
+    // Checked before the first fit, so a full disk does not end with a truncated temporary file
+    uint64_t fileSize = sizeof(header) + header.segmentCount * header.objectCount * sizeof(SnapshotRecord);
+    std::error_code spaceError;
+    std::filesystem::space_info space = std::filesystem::space(path.parent_path(), spaceError);
+    if (!spaceError && space.available < fileSize) {
+        std::cerr << color("warn") << "Not enough disk space for an ephemeris snapshot of " << fileSize / (1024 * 1024)
+                  << " MiB in " << path.parent_path() << ".\n" << std::flush;
+        return false;
+    }
+
+    std::filesystem::path temporaryPath = path;
+    temporaryPath += ".tmp";
+    std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) return false;
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    std::cout << color("log") << "Writing ephemeris snapshot: " << header.segmentCount << " segments of "
+              << header.segmentLength << " s, " << header.objectCount << " objects...\n" << std::flush;
+
+    std::vector<SnapshotRecord> segment(header.objectCount);
+    uint64_t validRecords = 0;
+    for (uint64_t s = 0; s < header.segmentCount && file; s++) {
+        if (!shouldDataManagerRun.load()) break;            // Shutdown: the snapshot is written on the next start
+
+        SpiceDouble segmentStart = header.start + s * header.segmentLength;
+        std::memset(segment.data(), 0, segment.size() * sizeof(SnapshotRecord));
+
+        // One segment per lock, so requests on the compute thread wait for at most one segment
+        {
+            std::lock_guard<std::mutex> lock(spiceMutex);
+            for (const CatalogObject& object : objectCatalog) {
+                if (!object.hasEphemeris || !object.hasOrientation) continue;
+
+                SnapshotRecord& record = segment[object.index];
+                record.valid = fitStateSegment(segmentStart, segmentStart + header.segmentLength, object.id, 0, false,
+                                               object.frameName.c_str(), SNAPSHOT_TOLERANCE, record.coefficients);
+                validRecords += record.valid;
+            }
+        }
+        file.write(reinterpret_cast<const char*>(segment.data()), segment.size() * sizeof(SnapshotRecord));
+    }
+
+    std::error_code ec;
+    file.close();
+    if (!file || !shouldDataManagerRun.load()) {
+        std::filesystem::remove(temporaryPath, ec);
+        return false;
+    }
+    std::filesystem::rename(temporaryPath, path, ec);       // Readers only ever see a complete file
+    if (ec) {
+        std::filesystem::remove(temporaryPath, ec);
+        return false;
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << color("log") << "Ephemeris snapshot written: " << path << " ("
+              << std::filesystem::file_size(path, ec) / (1024 * 1024) << " MiB, " << validRecords << " of "
+              << header.segmentCount * header.objectCount << " records valid, " << seconds << " s).\n\n" << std::flush;
+    return true;
+}
+
+
+
+// ─────────────────────────────────────────────
+// Snapshot Management - written by the data manager, read by every loop thread
+// ─────────────────────────────────────────────
+
+static std::shared_ptr<const EphemerisSnapshot> publishedSnapshot;     // Accessed with std::atomic_load/store only
+
+bool isEphemerisSnapshotEnabled() {
+    return serverOptions.snapshotSegment > 0.0;
+}
+
+bool loadEphemerisSnapshot(const std::filesystem::path& path, const std::string& kernelVersion) {
+    auto snapshot = std::make_shared<EphemerisSnapshot>();
+    if (!snapshot->map(path) || !snapshot->matches(kernelVersion)) return false;
+
+    std::atomic_store(&publishedSnapshot, std::shared_ptr<const EphemerisSnapshot>(std::move(snapshot)));
+    return true;
+}
+
+void unloadEphemerisSnapshot() {
+    std::atomic_store(&publishedSnapshot, std::shared_ptr<const EphemerisSnapshot>());     // Unmapped by the last reader
+}
+
+bool answerFromSnapshot(std::string_view request, std::string& response) {
+    std::shared_ptr<const EphemerisSnapshot> snapshot = std::atomic_load(&publishedSnapshot);
+    if (!snapshot) return false;
+    if (!isMultiRequest(request)) return snapshot->answer(request, response);
+
+    // Every request of the frame or none, in the layout of processRequest
+    static thread_local std::string reply;
+    response.assign(request.data(), MULTI_REQUEST_HEADER_LENGTH);
+    for (size_t offset = MULTI_REQUEST_HEADER_LENGTH; offset < request.size(); offset += EXPECTED_MESSAGE_LENGTH) {
+        if (!snapshot->answer(request.substr(offset, EXPECTED_MESSAGE_LENGTH), reply)) return false;
+        uint32_t length = static_cast<uint32_t>(reply.size());
+        response.append(reinterpret_cast<const char*>(&length), sizeof(length));
+        response.append(reply);
+    }
+    return true;
+}
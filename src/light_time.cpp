@@ -0,0 +1,179 @@
+/*
+ *  Copyright 2025 Mendel Dobondi-Reisz
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+// C++ Standard Libraries
+#include <cstdint>
+#include <vector>
+#include <cmath>
+
+// External Libraries
+#include <cspice/SpiceUsr.h>
+
+// Project Headers
+#include <barycentric_table.hpp>
+#include <object_catalog.hpp>
+#include <light_time.hpp>
+
+
+
+// ─────────────────────────────────────────────
+// Light Time Engine - LT+S for all bodies at once
+// ─────────────────────────────────────────────
+
+void LightTimeEngine::resize(size_t count) {
+    for (auto* component : { &px, &py, &pz, &vx, &vy, &vz, &lt }) component->assign(count, 0.0);
+    available.assign(count, 0);
+    target.assign(6 * count, 0.0);
+}
+
+bool LightTimeEngine::solve(SpiceDouble et, SpiceInt observerId, uint64_t objectMask) {
+    if (valid && et == this->et && observerId == this->observerId && (objectMask & ~solvedMask) == 0) return true;
+
+    valid = false;
+    this->et = et;
+    this->observerId = observerId;
+    this->solvedMask = objectMask;
+    size_t count = objectCatalog.size();
+    resize(count);
+
+    // Observer: SSB state from the shared table, acceleration from neighbouring states
+    barycentricTable.prepare(et, objectMask);
+    const BarycentricState& observerSsb = barycentricTable.observerState(observerId);
+    if (!observerSsb.available) return false;
+    for (int i = 0; i < 6; i++) observer[i] = observerSsb.state[i];
+
+    SpiceDouble before[6], after[6];
+    if (!barycentricState(observerId, et - LIGHT_TIME_ACCELERATION_STEP, before) ||
+        !barycentricState(observerId, et + LIGHT_TIME_ACCELERATION_STEP, after)) return false;
+    for (int i = 0; i < 3; i++) observerAcceleration[i] = (after[i + 3] - before[i + 3]) / (2.0 * LIGHT_TIME_ACCELERATION_STEP);
+
+    const SpiceDouble c = clight_c();
+
+    // First guess: geometric distance at et, straight from the table
+    for (const CatalogObject& object : objectCatalog) {
+        const BarycentricState* state = barycentricTable.objectState(object);
+        if (!(objectMask >> object.index & 1) || !state || !state->available) continue;
+        available[object.index] = 1;
+        for (int i = 0; i < 6; i++) target[6 * object.index + i] = state->state[i];
+    }
+
+    auto updateLightTime = [&]() {
+        for (size_t i = 0; i < count; i++) {
+            px[i] = target[6 * i + 0] - observer[0];
+            py[i] = target[6 * i + 1] - observer[1];
+            pz[i] = target[6 * i + 2] - observer[2];
+            lt[i] = std::sqrt(px[i] * px[i] + py[i] * py[i] + pz[i] * pz[i]) / c;
+        }
+    };
+    updateLightTime();
+
+    // Iterations: all targets at their own et - lt, then all light times together
+    for (int iteration = 0; iteration < LIGHT_TIME_ITERATIONS; iteration++) {
+        for (const CatalogObject& object : objectCatalog) {
+            if (!available[object.index]) continue;
+            available[object.index] = barycentricState(object.id, et - lt[object.index], &target[6 * object.index]);
+        }
+        for (size_t i = 0; i < count; i++) {
+            px[i] = target[6 * i + 0] - observer[0];
+            py[i] = target[6 * i + 1] - observer[1];
+            pz[i] = target[6 * i + 2] - observer[2];
+        }
+        if (iteration + 1 < LIGHT_TIME_ITERATIONS) updateLightTime();
+    }
+
+    // Light time rate and apparent velocity: v = vt (1 - dlt) - vo
+    for (size_t i = 0; i < count; i++) {
+        SpiceDouble tx = target[6 * i + 3], ty = target[6 * i + 4], tz = target[6 * i + 5];
+        SpiceDouble distance = std::sqrt(px[i] * px[i] + py[i] * py[i] + pz[i] * pz[i]);
+        SpiceDouble inverse = distance > 0.0 ? 1.0 / distance : 0.0;
+        SpiceDouble ux = px[i] * inverse, uy = py[i] * inverse, uz = pz[i] * inverse;
+
+        SpiceDouble closing = ux * (tx - observer[3]) + uy * (ty - observer[4]) + uz * (tz - observer[5]);
+        SpiceDouble dlt = (closing / c) / (1.0 + (ux * tx + uy * ty + uz * tz) / c);
+
+        vx[i] = tx * (1.0 - dlt) - observer[3];
+        vy[i] = ty * (1.0 - dlt) - observer[4];
+        vz[i] = tz * (1.0 - dlt) - observer[5];
+        lt[i] = distance / c;
+    }
+
+    /*
+     * Stellar aberration for reception, the stelab_c rotation in closed form:
+     * h = u x (vo / c), apparent p = p sqrt(1 - |h|^2) + h x p (h is perpendicular to p),
+     * and its time derivative for the velocity.
+     */
+    SpiceDouble sx = observer[3] / c, sy = observer[4] / c, sz = observer[5] / c;
+    SpiceDouble dsx = observerAcceleration[0] / c, dsy = observerAcceleration[1] / c, dsz = observerAcceleration[2] / c;
+    for (size_t i = 0; i < count; i++) {
+        SpiceDouble distance = std::sqrt(px[i] * px[i] + py[i] * py[i] + pz[i] * pz[i]);
+        SpiceDouble inverse = distance > 0.0 ? 1.0 / distance : 0.0;
+        SpiceDouble ux = px[i] * inverse, uy = py[i] * inverse, uz = pz[i] * inverse;
+
+        // du/dt = (v - u (u . v)) / |p|
+        SpiceDouble radial = ux * vx[i] + uy * vy[i] + uz * vz[i];
+        SpiceDouble dux = (vx[i] - ux * radial) * inverse;
+        SpiceDouble duy = (vy[i] - uy * radial) * inverse;
+        SpiceDouble duz = (vz[i] - uz * radial) * inverse;
+
+        SpiceDouble hx = uy * sz - uz * sy, hy = uz * sx - ux * sz, hz = ux * sy - uy * sx;
+        SpiceDouble dhx = (duy * sz - duz * sy) + (uy * dsz - uz * dsy);
+        SpiceDouble dhy = (duz * sx - dux * sz) + (uz * dsx - ux * dsz);
+        SpiceDouble dhz = (dux * sy - duy * sx) + (ux * dsy - uy * dsx);
+
+        SpiceDouble cosine = std::sqrt(1.0 - (hx * hx + hy * hy + hz * hz));
+        SpiceDouble dcosine = -(hx * dhx + hy * dhy + hz * dhz) / cosine;
+
+        SpiceDouble ax = px[i] * cosine + (hy * pz[i] - hz * py[i]);
+        SpiceDouble ay = py[i] * cosine + (hz * px[i] - hx * pz[i]);
+        SpiceDouble az = pz[i] * cosine + (hx * py[i] - hy * px[i]);
+
+        SpiceDouble avx = vx[i] * cosine + px[i] * dcosine + (dhy * pz[i] - dhz * py[i]) + (hy * vz[i] - hz * vy[i]);
+        SpiceDouble avy = vy[i] * cosine + py[i] * dcosine + (dhz * px[i] - dhx * pz[i]) + (hz * vx[i] - hx * vz[i]);
+        SpiceDouble avz = vz[i] * cosine + pz[i] * dcosine + (dhx * py[i] - dhy * px[i]) + (hx * vy[i] - hy * vx[i]);
+
+        px[i] = ax; py[i] = ay; pz[i] = az;
+        vx[i] = avx; vy[i] = avy; vz[i] = avz;
+    }
+
+    valid = true;
+    return true;
+}
+
+bool LightTimeEngine::correctedState(const CatalogObject& object, SpiceDouble state[6], SpiceDouble& lightTime) const {
+    if (!valid || !(solvedMask >> object.index & 1) || object.index >= available.size() || !available[object.index]) return false;
+
+    size_t i = object.index;
+    state[0] = px[i]; state[1] = py[i]; state[2] = pz[i];
+    state[3] = vx[i]; state[4] = vy[i]; state[5] = vz[i];
+    lightTime = lt[i];
+    return true;
+}
+
+void LightTimeEngine::invalidate() {
+    valid = false;
+}
+
+
+
+// ─────────────────────────────────────────────
+// Light Time Engine Instance
+// ─────────────────────────────────────────────
+
+LightTimeEngine lightTimeEngine;
+
+void invalidateLightTimeEngine() {
+    lightTimeEngine.invalidate();
+}
@@ -15,11 +15,15 @@
  */
 
 // Standard C++ Libraries
+#include <iostream>
 #include <thread>
+#include <string>
+#include <vector>
 #include <csignal>
 
 // Project headers
 #include <server_threads.hpp>
+#include <worker_pool.hpp>
 #include <utils.hpp>
 
 
@@ -29,24 +33,34 @@
 // ─────────────────────────────────────────────
 
 int main(int argc, char* argv[]) {
+    if (isSpiceWorkerInvocation(argc, argv)) return runSpiceWorker(argc, argv);
+
     checkArgc(argc, argv);
     
     int port;
     int syncInterval;
     loadValues(argc, argv, port, syncInterval);
+    loadOptions(argc, argv, serverOptions);
 
     printTitle();
     printExitOption();
+
+    workerProcessOptions.assign(argv + 3, argv + argc);               // Also used by the swap worker without --workers
+    if (serverOptions.workers > 0 && !startWorkerPool(serverOptions.workers, workerProcessOptions)) {
+        std::cerr << color("warn") << "Falling back to in-process SPICE computation.\n" << std::flush;
+    }
     
     std::thread dataManagerThread(dataManagerWorker, syncInterval);
+    std::thread computeManagerThread(computeManagerWorker);
     std::thread webSocketManagerThread(webSocketManagerWorker, port);
     
     dataManagerPointer = &dataManagerThread;
+    computeManagerPointer = &computeManagerThread;
     webSocketManagerPointer = &webSocketManagerThread;
     std::signal(SIGTERM, handleSignal);
 
     waitForExitCommand();
-    gracefulShutdown(dataManagerPointer, webSocketManagerPointer);
+    gracefulShutdown(dataManagerPointer, computeManagerPointer, webSocketManagerPointer);
     
     return SUCCESSFUL_EXIT;
 }
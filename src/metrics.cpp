@@ -0,0 +1,319 @@
+/*
+ *  Copyright 2025 Mendel Dobondi-Reisz
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+// C++ Standard Libraries
+#include <string_view>
+#include <algorithm>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <mutex>
+
+// Project Headers
+#include <metrics.hpp>
+#include <thread_registry.hpp>
+#include <websocket_manager.hpp>
+#include <compute_manager.hpp>
+#include <response_cache.hpp>
+#include <prefetch_manager.hpp>
+#include <worker_pool.hpp>
+#include <spice_core.hpp>
+#include <utils.hpp>
+
+
+
+// ─────────────────────────────────────────────
+// Thread Metrics - one writer per block, read by the exporter
+// ─────────────────────────────────────────────
+
+static ThreadRegistry<ThreadMetrics> threadMetrics;
+
+static ThreadMetrics& currentThreadMetrics() {
+    return threadMetrics.current();
+}
+
+static void add(std::atomic<uint64_t>& counter, uint64_t amount) {
+    counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+size_t metricsBucket(uint64_t value) {
+    if (value < (uint64_t(1) << METRICS_FIRST_OCTAVE)) return 0;
+
+    int octave = 63 - __builtin_clzll(value);
+    if (octave >= METRICS_FIRST_OCTAVE + METRICS_OCTAVES) return METRICS_BUCKETS - 1;
+
+    size_t sub = (value >> (octave - METRICS_SUB_BUCKET_BITS)) & (METRICS_SUB_BUCKETS - 1);
+    return 1 + static_cast<size_t>(octave - METRICS_FIRST_OCTAVE) * METRICS_SUB_BUCKETS + sub;
+}
+
+uint64_t metricsBucketBound(size_t bucket) {
+    if (bucket == 0) return uint64_t(1) << METRICS_FIRST_OCTAVE;
+    if (bucket >= METRICS_BUCKETS - 1) return UINT64_MAX;
+
+    int octave = METRICS_FIRST_OCTAVE + static_cast<int>((bucket - 1) / METRICS_SUB_BUCKETS);
+    uint64_t sub = (bucket - 1) % METRICS_SUB_BUCKETS;
+    return (uint64_t(1) << octave) + ((sub + 1) << (octave - METRICS_SUB_BUCKET_BITS));
+}
+
+void MetricsHistogram::record(uint64_t value) {
+    add(buckets[metricsBucket(value)], 1);
+    add(sum, value);
+}
+
+
+
+// ─────────────────────────────────────────────
+// Metrics Recording - hot path
+// ─────────────────────────────────────────────
+
+uint64_t steadyNanoseconds() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+bool isMetricsEnabled() {
+    return serverOptions.metrics;
+}
+
+void bindThreadMetrics(ThreadMetrics* block) {
+    threadMetrics.bind(block);
+}
+
+void countMetric(MetricsCounter counter, uint64_t amount) {
+    if (!isMetricsEnabled()) return;
+    add(currentThreadMetrics().counters[static_cast<size_t>(counter)], amount);
+}
+
+void countRequest(std::string_view request) {
+    if (!isMetricsEnabled()) return;
+    if (isMultiRequest(request)) {
+        countMetric(MetricsCounter::REQUESTS_MULTI);
+        return;
+    }
+
+    switch (static_cast<MessageMode>(request[sizeof(double)] & ~MESSAGE_FLAG_TDB)) {
+        case MessageMode::ALL_INSTANTANEOUS:         countMetric(MetricsCounter::REQUESTS_I); break;
+        case MessageMode::ALL_LIGHT_TIME_ADJUSTED:   countMetric(MetricsCounter::REQUESTS_L); break;
+        case MessageMode::RANGE_INSTANTANEOUS:       countMetric(MetricsCounter::REQUESTS_RANGE_I); break;
+        case MessageMode::RANGE_LIGHT_TIME_ADJUSTED: countMetric(MetricsCounter::REQUESTS_RANGE_L); break;
+        default:                                     countMetric(MetricsCounter::REQUESTS_OTHER); break;
+    }
+}
+
+void countResponse(std::string_view response) {
+    if (!isMetricsEnabled() || response.size() <= sizeof(double)) return;
+
+    switch (static_cast<MessageMode>(response[sizeof(double)] & ~MESSAGE_FLAG_TDB)) {
+        case MessageMode::ERROR:   countMetric(MetricsCounter::ERRORS_E); break;
+        case MessageMode::ERROR_I: countMetric(MetricsCounter::ERRORS_F); break;
+        case MessageMode::ERROR_L: countMetric(MetricsCounter::ERRORS_G); break;
+        default: break;
+    }
+}
+
+void recordBuffered(size_t bytes) {
+    if (!isMetricsEnabled()) return;
+    currentThreadMetrics().buffered.record(bytes);
+}
+
+uint64_t stageStart() {
+    return isMetricsEnabled() ? steadyNanoseconds() : 0;
+}
+
+void recordStage(MetricsStage stage, uint64_t start) {
+    if (!start || !isMetricsEnabled()) return;         // Traced requests take a start time without --metrics
+    currentThreadMetrics().stages[static_cast<size_t>(stage)].record(steadyNanoseconds() - start);
+}
+
+
+
+// ─────────────────────────────────────────────
+// Kernel Metrics - data manager thread
+// ─────────────────────────────────────────────
+
+static std::mutex kernelMetricsMutex;
+static std::string kernelVersion;
+static double lastKernelSync = 0.0;                 // Unix seconds, 0 until it happened
+static double lastKernelSwap = 0.0;
+
+static double unixSeconds() {
+    return std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+void recordKernelSync() {
+    std::lock_guard<std::mutex> lock(kernelMetricsMutex);
+    lastKernelSync = unixSeconds();
+}
+
+void recordKernelSwap(const std::string& version) {
+    std::lock_guard<std::mutex> lock(kernelMetricsMutex);
+    kernelVersion = version;
+    lastKernelSwap = unixSeconds();
+}
+
+
+
+// ─────────────────────────────────────────────
+// Metrics Export - Prometheus text format
+// ─────────────────────────────────────────────
+
+static const char* stageNames[] = { "queue", "utc_to_et", "spkez", "sxform", "serialize", "send" };
+static_assert(sizeof(stageNames) / sizeof(stageNames[0]) == static_cast<size_t>(MetricsStage::COUNT), "One name per stage");
+
+struct MetricsTotals {
+    uint64_t counters[static_cast<size_t>(MetricsCounter::COUNT)] = {};
+    uint64_t stages[static_cast<size_t>(MetricsStage::COUNT)][METRICS_BUCKETS + 1] = {};    // Buckets, then the sum
+    uint64_t buffered[METRICS_BUCKETS + 1] = {};
+};
+
+static void addHistogram(uint64_t* total, const MetricsHistogram& histogram) {
+    for (size_t i = 0; i < METRICS_BUCKETS; i++) total[i] += histogram.buckets[i].load(std::memory_order_relaxed);
+    total[METRICS_BUCKETS] += histogram.sum.load(std::memory_order_relaxed);
+}
+
+static void addBlock(MetricsTotals& totals, const ThreadMetrics& block) {
+    for (size_t i = 0; i < static_cast<size_t>(MetricsCounter::COUNT); i++) {
+        totals.counters[i] += block.counters[i].load(std::memory_order_relaxed);
+    }
+    for (size_t i = 0; i < static_cast<size_t>(MetricsStage::COUNT); i++) addHistogram(totals.stages[i], block.stages[i]);
+    addHistogram(totals.buffered, block.buffered);
+}
+
+static void appendf(std::string& out, const char* format, ...) __attribute__((format(printf, 2, 3)));
+static void appendf(std::string& out, const char* format, ...) {
+    char line[256];
+    va_list arguments;
+    va_start(arguments, format);
+    int length = std::vsnprintf(line, sizeof(line), format, arguments);
+    va_end(arguments);
+    if (length > 0) out.append(line, std::min(static_cast<size_t>(length), sizeof(line) - 1));
+}
+
+// Label values escape backslash, double quote and line feed, any length
+static void appendLabelValue(std::string& out, std::string_view value) {
+    for (char c : value) {
+        if (c == '\\') out += "\\\\";
+        else if (c == '"') out += "\\\"";
+        else if (c == '\n') out += "\\n";
+        else out += c;
+    }
+}
+
+static void appendHeader(std::string& out, const char* name, const char* type, const char* help) {
+    appendf(out, "# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+}
+
+static void appendCounter(std::string& out, const char* name, const char* labels, uint64_t value) {
+    appendf(out, "%s%s %llu\n", name, labels, static_cast<unsigned long long>(value));
+}
+
+// Buckets are cumulative in Prometheus, 'scale' turns the recorded unit into the exported one
+static void appendHistogram(std::string& out, const char* name, const char* label, const uint64_t* totals, double scale) {
+    const char* separator = *label ? "," : "";
+    uint64_t count = 0;
+    for (size_t i = 0; i < METRICS_BUCKETS; i++) {
+        count += totals[i];
+        if (i == METRICS_BUCKETS - 1) {
+            appendf(out, "%s_bucket{%s%sle=\"+Inf\"} %llu\n", name, label, separator, static_cast<unsigned long long>(count));
+        }
+        else {
+            appendf(out, "%s_bucket{%s%sle=\"%.9g\"} %llu\n", name, label, separator,
+                    metricsBucketBound(i) * scale, static_cast<unsigned long long>(count));
+        }
+    }
+    std::string labels = *label ? std::string("{") + label + "}" : std::string();
+    appendf(out, "%s_sum%s %.9g\n", name, labels.c_str(), totals[METRICS_BUCKETS] * scale);
+    appendf(out, "%s_count%s %llu\n", name, labels.c_str(), static_cast<unsigned long long>(count));
+}
+
+std::string renderMetrics() {
+    MetricsTotals totals;
+    threadMetrics.forEach([&](const ThreadMetrics& block) { addBlock(totals, block); });
+    if (workerPool) workerPool->forEachWorkerMetrics([&](const ThreadMetrics& block) { addBlock(totals, block); });
+
+    auto counter = [&](MetricsCounter index) { return totals.counters[static_cast<size_t>(index)]; };
+    std::string out;
+    out.reserve(64 * 1024);
+
+    appendHeader(out, "hera_requests_total", "counter", "Requests received, by mode.");
+    appendCounter(out, "hera_requests_total", "{mode=\"i\"}", counter(MetricsCounter::REQUESTS_I));
+    appendCounter(out, "hera_requests_total", "{mode=\"l\"}", counter(MetricsCounter::REQUESTS_L));
+    appendCounter(out, "hera_requests_total", "{mode=\"I\"}", counter(MetricsCounter::REQUESTS_RANGE_I));
+    appendCounter(out, "hera_requests_total", "{mode=\"L\"}", counter(MetricsCounter::REQUESTS_RANGE_L));
+    appendCounter(out, "hera_requests_total", "{mode=\"M\"}", counter(MetricsCounter::REQUESTS_MULTI));
+    appendCounter(out, "hera_requests_total", "{mode=\"other\"}", counter(MetricsCounter::REQUESTS_OTHER));
+
+    appendHeader(out, "hera_error_responses_total", "counter", "Error responses sent, by error mode.");
+    appendCounter(out, "hera_error_responses_total", "{code=\"e\"}", counter(MetricsCounter::ERRORS_E));
+    appendCounter(out, "hera_error_responses_total", "{code=\"f\"}", counter(MetricsCounter::ERRORS_F));
+    appendCounter(out, "hera_error_responses_total", "{code=\"g\"}", counter(MetricsCounter::ERRORS_G));
+
+    appendHeader(out, "hera_received_bytes_total", "counter", "WebSocket payload bytes received.");
+    appendCounter(out, "hera_received_bytes_total", "", counter(MetricsCounter::BYTES_IN));
+    appendHeader(out, "hera_sent_bytes_total", "counter", "WebSocket payload bytes sent, after encoding and compression.");
+    appendCounter(out, "hera_sent_bytes_total", "", counter(MetricsCounter::BYTES_OUT));
+
+    appendHeader(out, "hera_stage_duration_seconds", "histogram", "Time spent per request stage.");
+    for (size_t i = 0; i < static_cast<size_t>(MetricsStage::COUNT); i++) {
+        std::string label = std::string("stage=\"") + stageNames[i] + "\"";
+        appendHistogram(out, "hera_stage_duration_seconds", label.c_str(), totals.stages[i], 1e-9);
+    }
+
+    appendHeader(out, "hera_connection_buffered_bytes", "histogram", "Bytes left in the connection's send buffer after each send.");
+    appendHistogram(out, "hera_connection_buffered_bytes", "", totals.buffered, 1.0);
+
+    appendHeader(out, "hera_connections", "gauge", "Open WebSocket connections.");
+    appendCounter(out, "hera_connections", "", activeConnections.load(std::memory_order_relaxed));
+    appendHeader(out, "hera_dropped_frames_total", "counter", "Real-time frames dropped by backpressure.");
+    appendCounter(out, "hera_dropped_frames_total", "", droppedFrames.load(std::memory_order_relaxed));
+
+    CoalescingStats coalescing = coalescingStats();
+    appendHeader(out, "hera_computed_requests_total", "counter", "Requests handed to the compute backend.");
+    appendCounter(out, "hera_computed_requests_total", "", coalescing.requests);
+    appendHeader(out, "hera_coalesced_requests_total", "counter", "Computed requests answered from an identical request's computation.");
+    appendCounter(out, "hera_coalesced_requests_total", "", coalescing.coalesced);
+
+    if (isResponseCacheEnabled()) {
+        ResponseCacheStats cache = responseCache.stats();
+        appendHeader(out, "hera_response_cache_lookups_total", "counter", "Response cache lookups, by result.");
+        appendCounter(out, "hera_response_cache_lookups_total", "{result=\"hit\"}", cache.hits);
+        appendCounter(out, "hera_response_cache_lookups_total", "{result=\"miss\"}", cache.misses);
+    }
+
+    if (isPrefetchEnabled()) {
+        PrefetchStats prefetch = prefetchStats();
+        appendHeader(out, "hera_prefetch_requests_total", "counter", "Steady-stream requests, by whether a prefetched frame answered them.");
+        appendCounter(out, "hera_prefetch_requests_total", "{result=\"hit\"}", prefetch.hits);
+        appendCounter(out, "hera_prefetch_requests_total", "{result=\"miss\"}", prefetch.misses);
+        appendHeader(out, "hera_prefetch_frames_total", "counter", "Frames submitted ahead of the client.");
+        appendCounter(out, "hera_prefetch_frames_total", "", prefetch.computed);
+    }
+
+    std::lock_guard<std::mutex> lock(kernelMetricsMutex);
+    appendHeader(out, "hera_kernel_info", "gauge", "Kernel version in use.");
+    out += "hera_kernel_info{version=\"";
+    appendLabelValue(out, kernelVersion);
+    out += "\"} 1\n";
+    appendHeader(out, "hera_kernel_last_sync_timestamp_seconds", "gauge", "Unix time of the last remote version check.");
+    appendf(out, "hera_kernel_last_sync_timestamp_seconds %.3f\n", lastKernelSync);
+    appendHeader(out, "hera_kernel_last_swap_timestamp_seconds", "gauge", "Unix time the kernel version in use was loaded.");
+    appendf(out, "hera_kernel_last_swap_timestamp_seconds %.3f\n", lastKernelSwap);
+
+    return out;
+}
@@ -0,0 +1,152 @@
+/*
+ *  Copyright 2025 Mendel Dobondi-Reisz
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+// C++ Standard Libraries
+#include <unordered_set>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// External Libraries
+#include <cspice/SpiceUsr.h>
+
+// Project Headers
+#include <object_catalog.hpp>
+#include <spice_core.hpp>
+#include <utils.hpp>
+
+
+
+// ─────────────────────────────────────────────
+// Catalog Config - optional object list file
+// ─────────────────────────────────────────────
+
+/*
+ * One object per line: <id> <name> [frame]
+ * Blank lines and everything after '#' are ignored.
+ */
+bool loadCatalogConfig(const std::string& path, std::vector<CatalogEntryConfig>& entries) {
+    std::ifstream file(path);
+    if (!file) {
+        std::cerr << color("error") << "Cannot open object catalog: " << path << "\n" << std::flush;
+        return false;
+    }
+
+    entries.clear();
+    std::string line;
+    for (int lineNumber = 1; std::getline(file, line); lineNumber++) {
+        line = line.substr(0, line.find('#'));
+        std::istringstream fields(line);
+
+        CatalogEntryConfig entry;
+        if (!(fields >> entry.id)) {
+            if (line.find_first_not_of(" \t\r") == std::string::npos) continue;
+            std::cerr << color("error") << path << ":" << lineNumber << ": expected <id> <name> [frame]\n" << std::flush;
+            return false;
+        }
+        if (!(fields >> entry.name)) {
+            std::cerr << color("error") << path << ":" << lineNumber << ": missing object name\n" << std::flush;
+            return false;
+        }
+        fields >> entry.frameName;
+        entries.push_back(std::move(entry));
+    }
+
+    if (entries.empty() || entries.size() > MAX_CATALOG_OBJECTS) {
+        std::cerr << color("error") << path << ": expected 1 to " << MAX_CATALOG_OBJECTS << " objects\n" << std::flush;
+        return false;
+    }
+    return true;
+}
+
+
+
+// ─────────────────────────────────────────────
+// Object Catalog - resolved once per kernel version
+// ─────────────────────────────────────────────
+
+std::vector<CatalogObject> objectCatalog;
+
+static std::unordered_set<SpiceInt> loadedEphemerisTargets() {
+    SPICEINT_CELL(targets, 10000);
+    std::unordered_set<SpiceInt> result;
+
+    SpiceInt count;
+    ktotal_c("SPK", &count);
+    for (SpiceInt i = 0; i < count; i++) {
+        SpiceChar file[512], type[32], source[512];
+        SpiceInt handle;
+        SpiceBoolean found;
+        kdata_c(i, "SPK", sizeof(file), sizeof(type), sizeof(source), file, type, source, &handle, &found);
+        if (!found) continue;
+
+        scard_c(0, &targets);
+        spkobj_c(file, &targets);
+        for (SpiceInt j = 0; j < card_c(&targets); j++) result.insert(SPICE_CELL_ELEM_I(&targets, j));
+    }
+
+    if (failed_c()) reset_c();
+    return result;
+}
+
+void buildObjectCatalog() {
+    std::vector<CatalogEntryConfig> entries;
+    if (serverOptions.catalogPath.empty() || !loadCatalogConfig(serverOptions.catalogPath, entries)) {
+        if (!serverOptions.catalogPath.empty()) {
+            std::cerr << color("warn") << "Using the built-in object list.\n" << std::flush;
+        }
+        entries.clear();
+        for (const auto& [id, name] : defaultObjects) entries.push_back({ id, std::string(name), "" });
+    }
+
+    std::unordered_set<SpiceInt> targets = loadedEphemerisTargets();
+
+    objectCatalog.clear();
+    for (const CatalogEntryConfig& entry : entries) {
+        CatalogObject object;
+        object.id = entry.id;
+        object.name = entry.name;
+        object.frameName = entry.frameName.empty() ? getBodyFixedFrameName(entry.id) : entry.frameName;
+        if (object.frameName == "UNKNOWN") object.frameName.clear();
+
+        object.frameId = 0;
+        if (!object.frameName.empty()) namfrm_c(object.frameName.c_str(), &object.frameId);
+        if (failed_c()) reset_c();
+
+        object.hasEphemeris = entry.id == 0 || targets.count(entry.id) > 0;   // The SSB is the root of every chain
+        object.hasOrientation = object.frameId != 0;
+        object.index = static_cast<uint8_t>(objectCatalog.size());
+
+        if (!object.hasEphemeris || !object.hasOrientation) {
+            std::cerr << color("warn") << "Object " << object.id << " (" << object.name << ") is skipped: no "
+                      << (object.hasEphemeris ? "body-fixed frame" : "SPK data") << " in the loaded kernels.\n" << std::flush;
+        }
+        objectCatalog.push_back(std::move(object));
+    }
+}
+
+void clearObjectCatalog() {
+    objectCatalog.clear();
+}
+
+const CatalogObject* findCatalogObject(SpiceInt id) {
+    for (const CatalogObject& object : objectCatalog) {
+        if (object.id == id) return &object;
+    }
+    return nullptr;
+}
@@ -0,0 +1,214 @@
+/*
+ *  Copyright 2025 Mendel Dobondi-Reisz
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+// C++ Standard Libraries
+#include <unordered_map>
+#include <string_view>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#include <limits>
+#include <atomic>
+#include <string>
+#include <cmath>
+
+// External Libraries
+#include <uWebSockets/App.h>
+
+// Project Headers
+#include <prefetch_manager.hpp>
+#include <websocket_manager.hpp>
+#include <compute_manager.hpp>
+#include <response_cache.hpp>
+#include <response_encoding.hpp>
+#include <request_trace.hpp>
+#include <spice_core.hpp>
+#include <utils.hpp>
+
+
+
+// ─────────────────────────────────────────────
+// Prefetch Stream - request cadence of one connection
+// ─────────────────────────────────────────────
+
+// Every loop thread follows its own connections, only the counters are shared between loops
+static thread_local std::unordered_map<WS*, PrefetchStream> streams;
+static std::atomic<uint64_t> prefetchHits = 0;
+static std::atomic<uint64_t> prefetchMisses = 0;
+static std::atomic<uint64_t> prefetchComputed = 0;
+
+static double requestTimestamp(std::string_view request) {
+    double timestamp;
+    std::memcpy(&timestamp, request.data(), sizeof(timestamp));
+    return timestamp;
+}
+
+static double stepTolerance(const PrefetchStream& stream) {
+    return PREFETCH_STEP_TOLERANCE * std::fabs(stream.step);
+}
+
+// The response is sent with the client's timestamp, so the frame must be for that epoch up to rounding
+static bool sameEpoch(double a, double b) {
+    return std::fabs(a - b) <= PREFETCH_MATCH_ULPS * std::numeric_limits<double>::epsilon() * std::max(std::fabs(a), std::fabs(b));
+}
+
+static void followCadence(PrefetchStream& stream, std::string_view request) {
+    double timestamp = requestTimestamp(request);
+    std::string_view signature = request.substr(sizeof(double));
+
+    if (signature != stream.signature) {                        // Other mode, observer or selection: a new stream
+        stream.signature.assign(signature);
+        stream.step = 0.0;
+        stream.streak = 1;
+        stream.frames.clear();
+    }
+    else {
+        double step = timestamp - stream.lastTimestamp;
+        if (stream.step != 0.0 && std::fabs(step - stream.step) <= stepTolerance(stream)) stream.streak++;
+        else {                                                  // Seek or new rate: nothing ahead is of use
+            stream.step = step;
+            stream.streak = step != 0.0 ? 2 : 1;
+            stream.frames.clear();
+        }
+    }
+    stream.lastTimestamp = timestamp;
+
+    // Frames the client went past will not be asked for, unless it already did
+    double tolerance = stepTolerance(stream);
+    stream.frames.erase(std::remove_if(stream.frames.begin(), stream.frames.end(), [&](const PrefetchedFrame& frame) {
+        return frame.waitingRequest.empty() && (frame.timestamp - timestamp) * stream.step < -tolerance;
+    }), stream.frames.end());
+}
+
+static void sendPrefetched(WS* ws, const std::string& request, std::string& response, uWS::OpCode opCode) {
+    std::memcpy(response.data(), request.data(), sizeof(double));  // The client's own timestamp is echoed
+    sendResponse(ws, response, requestComponents(request), opCode);
+}
+
+
+
+// ─────────────────────────────────────────────
+// Prefetch Handlers - loop thread only
+// ─────────────────────────────────────────────
+
+bool isPrefetchEnabled() {
+    return serverOptions.prefetchDepth > 0;
+}
+
+bool isPrefetchableRequest(std::string_view request) {
+    if (request.size() != EXPECTED_MESSAGE_LENGTH && request.size() != EXPECTED_MESSAGE_LENGTH + SELECTION_TRAILER_LENGTH) return false;
+    MessageMode mode = static_cast<MessageMode>(request[sizeof(double)] & ~MESSAGE_FLAG_TDB);
+    return (mode == MessageMode::ALL_INSTANTANEOUS || mode == MessageMode::ALL_LIGHT_TIME_ADJUSTED) &&
+           std::isfinite(requestTimestamp(request));
+}
+
+PrefetchResult takePrefetched(WS* ws, const std::string& request, uWS::OpCode opCode) {
+    uint64_t session = ws->getUserData()->session;
+    PrefetchStream& stream = streams[ws];
+    if (stream.session != session) stream = PrefetchStream{ session };
+
+    followCadence(stream, request);
+    if (stream.streak < PREFETCH_MIN_STREAK) return PrefetchResult::MISS;
+
+    double timestamp = requestTimestamp(request);
+    for (auto it = stream.frames.begin(); it != stream.frames.end(); ++it) {
+        if (!it->waitingRequest.empty() || !sameEpoch(it->timestamp, timestamp)) continue;
+        if (it->generation != responseCache.generation()) {     // Computed from the previous kernel version
+            stream.frames.erase(it);
+            break;
+        }
+
+        prefetchHits.fetch_add(1, std::memory_order_relaxed);
+        if (it->response.empty()) {                             // Answered as soon as it is computed
+            it->waitingRequest = request;
+            it->waitingOpCode = opCode;
+            it->waitingTrace = currentTrace();
+            return PrefetchResult::WAITING;
+        }
+        sendPrefetched(ws, request, it->response, opCode);
+        stream.frames.erase(it);
+        return PrefetchResult::SENT;
+    }
+
+    prefetchMisses.fetch_add(1, std::memory_order_relaxed);
+    return PrefetchResult::MISS;
+}
+
+void schedulePrefetch(WS* ws, uWS::OpCode opCode) {
+    auto found = streams.find(ws);
+    if (found == streams.end() || found->second.streak < PREFETCH_MIN_STREAK) return;
+    PrefetchStream& stream = found->second;
+
+    int depth = std::min(serverOptions.prefetchDepth, PREFETCH_MAX_DEPTH);
+    uint64_t generation = responseCache.generation();
+
+    for (int k = 1; k <= depth; k++) {
+        double timestamp = stream.lastTimestamp + k * stream.step;
+        bool present = std::any_of(stream.frames.begin(), stream.frames.end(), [&](const PrefetchedFrame& frame) {
+            return sameEpoch(frame.timestamp, timestamp);
+        });
+        if (present) continue;
+
+        std::string request(sizeof(double), '\0');
+        std::memcpy(request.data(), &timestamp, sizeof(timestamp));
+        request.append(stream.signature);
+
+        // Refused while client requests wait for the backend: it is busy, prefetch backs off
+        if (!submitPrefetchTask({ ws, stream.session, uWS::Loop::get(), opCode, request, generation, 0, true })) return;
+        stream.frames.push_back({ timestamp, std::move(request), std::string(), generation });
+        prefetchComputed.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void completePrefetch(WS* ws, const std::string& request, std::string&& response, uint64_t generation) {
+    auto found = streams.find(ws);
+    if (found == streams.end() || found->second.session != ws->getUserData()->session) return;
+
+    auto& frames = found->second.frames;
+    auto it = std::find_if(frames.begin(), frames.end(), [&](const PrefetchedFrame& frame) {
+        return frame.response.empty() && frame.request == request;
+    });
+    if (it == frames.end()) return;                             // The client went elsewhere in the meantime
+
+    if (it->waitingRequest.empty()) {
+        it->response = std::move(response);
+        return;
+    }
+
+    std::string waitingRequest = std::move(it->waitingRequest);
+    uWS::OpCode opCode = it->waitingOpCode;
+    setCurrentTrace(it->waitingTrace);
+    frames.erase(it);
+
+    // Kernels were swapped while it was computed: the client's request is computed again, still traced
+    if (generation != responseCache.generation()) {
+        submitComputeTask({ ws, ws->getUserData()->session, uWS::Loop::get(), opCode, std::move(waitingRequest),
+                            responseCache.generation() });
+        setCurrentTrace(0);
+        return;
+    }
+    sendPrefetched(ws, waitingRequest, response, opCode);
+    traceInstant(TraceStage::REQUEST_END);
+    setCurrentTrace(0);
+}
+
+void endPrefetch(WS* ws) {
+    streams.erase(ws);
+}
+
+PrefetchStats prefetchStats() {
+    return { prefetchHits.load(), prefetchMisses.load(), prefetchComputed.load() };
+}
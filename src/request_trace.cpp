@@ -0,0 +1,222 @@
+/*
+ *  Copyright 2025 Mendel Dobondi-Reisz
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+// C++ Standard Libraries
+#include <filesystem>
+#include <iostream>
+#include <fstream>
+#include <cstring>
+#include <cstdint>
+#include <cstdio>
+#include <atomic>
+#include <chrono>
+#include <string>
+
+// System Libraries
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// Project Headers
+#include <request_trace.hpp>
+#include <thread_registry.hpp>
+#include <worker_pool.hpp>
+#include <metrics.hpp>
+#include <utils.hpp>
+
+
+
+// ─────────────────────────────────────────────
+// Trace Ring - one writer, lives in process or shared memory
+// ─────────────────────────────────────────────
+
+static ThreadRegistry<TraceRing> traceRings;
+static thread_local char threadName[TRACE_THREAD_NAME_LENGTH] = "thread";
+static thread_local uint64_t threadTrace = 0;
+
+static void nameRing(TraceRing* ring, const char* name) {
+    ring->pid.store(static_cast<int32_t>(getpid()), std::memory_order_relaxed);
+    ring->tid.store(static_cast<int32_t>(syscall(SYS_gettid)), std::memory_order_relaxed);
+    std::snprintf(ring->name, sizeof(ring->name), "%s", name);
+}
+
+static TraceRing& currentRing() {
+    return traceRings.current([](TraceRing& ring) { nameRing(&ring, threadName); });
+}
+
+static void writeEvent(TraceStage stage, uint64_t start, uint64_t duration, int32_t object) {
+    TraceRing& ring = currentRing();
+    uint64_t position = ring.head.load(std::memory_order_relaxed);
+    TraceEvent& event = ring.events[position & (TRACE_RING_EVENTS - 1)];
+
+    event.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    event.trace.store(threadTrace, std::memory_order_relaxed);
+    event.start.store(start, std::memory_order_relaxed);
+    event.duration.store(duration, std::memory_order_relaxed);
+    event.detail.store(static_cast<uint64_t>(static_cast<uint32_t>(object)) << 32 | static_cast<uint8_t>(stage),
+                       std::memory_order_relaxed);
+    event.sequence.store(position + 1, std::memory_order_release);
+    ring.head.store(position + 1, std::memory_order_release);
+}
+
+
+
+// ─────────────────────────────────────────────
+// Request Tracing - hot path
+// ─────────────────────────────────────────────
+
+static std::atomic<uint64_t> nextTrace = 1;
+
+bool isTracingEnabled() {
+    return serverOptions.traceSampling > 0;
+}
+
+uint64_t sampleTrace() {
+    if (!isTracingEnabled()) return 0;
+
+    static thread_local uint64_t requests = 0;
+    if (requests++ % static_cast<uint64_t>(serverOptions.traceSampling)) return 0;
+    return nextTrace.fetch_add(1, std::memory_order_relaxed);
+}
+
+uint64_t currentTrace() {
+    return threadTrace;
+}
+
+void setCurrentTrace(uint64_t trace) {
+    threadTrace = trace;
+}
+
+uint64_t traceStart() {
+    return threadTrace ? steadyNanoseconds() : 0;
+}
+
+void traceStage(TraceStage stage, uint64_t start, int32_t object) {
+    if (!threadTrace || !start) return;
+    uint64_t now = steadyNanoseconds();
+    writeEvent(stage, start, now > start ? now - start : 0, object);
+}
+
+void traceInstant(TraceStage stage) {
+    if (!threadTrace) return;
+    writeEvent(stage, steadyNanoseconds(), 0, 0);
+}
+
+void nameTraceThread(const char* name) {
+    std::snprintf(threadName, sizeof(threadName), "%s", name);
+}
+
+void bindTraceRing(TraceRing* ring, const char* name) {
+    nameRing(ring, name);                                       // A respawned worker takes over the ring
+    traceRings.bind(ring);
+}
+
+
+
+// ─────────────────────────────────────────────
+// Trace Export - Chrome Trace Event format
+// ─────────────────────────────────────────────
+
+static const char* stageNames[] = {
+    "request", "request", "onMessage", "takePrefetched", "responseCache", "snapshot", "submitComputeTask", "queue",
+    "spiceMutex", "workerRing", "processRequest", "setETime", "barycentricTable", "lightTimeEngine", "loadState",
+    "deliverResponse", "loopWait", "send"
+};
+static_assert(sizeof(stageNames) / sizeof(stageNames[0]) == static_cast<size_t>(TraceStage::COUNT), "One name per stage");
+
+static void writeRingEvents(std::ofstream& file, const TraceRing& ring, bool& first, size_t& written) {
+    int32_t pid = ring.pid.load(std::memory_order_relaxed);
+    int32_t tid = ring.tid.load(std::memory_order_relaxed);
+    uint64_t head = ring.head.load(std::memory_order_acquire);
+    if (!head) return;
+
+    char line[512];
+    std::snprintf(line, sizeof(line), "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":\"%.*s\"}}",
+                  first ? "" : ",", pid, tid, TRACE_THREAD_NAME_LENGTH, ring.name);
+    file << line;
+    first = false;
+
+    for (uint64_t position = head > TRACE_RING_EVENTS ? head - TRACE_RING_EVENTS : 0; position < head; position++) {
+        const TraceEvent& event = ring.events[position & (TRACE_RING_EVENTS - 1)];
+        uint64_t sequence = event.sequence.load(std::memory_order_acquire);
+        uint64_t trace = event.trace.load(std::memory_order_relaxed);
+        uint64_t start = event.start.load(std::memory_order_relaxed);
+        uint64_t duration = event.duration.load(std::memory_order_relaxed);
+        uint64_t detail = event.detail.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence != position + 1 || event.sequence.load(std::memory_order_relaxed) != sequence) continue;  // Overwritten meanwhile
+
+        TraceStage stage = static_cast<TraceStage>(detail & 0xff);
+        if (stage >= TraceStage::COUNT) continue;
+        int32_t object = static_cast<int32_t>(static_cast<uint32_t>(detail >> 32));
+
+        // Microseconds, the Chrome trace time unit
+        if (stage == TraceStage::REQUEST_BEGIN || stage == TraceStage::REQUEST_END) {
+            std::snprintf(line, sizeof(line),
+                          ",\n{\"name\":\"request\",\"cat\":\"request\",\"ph\":\"%s\",\"id\":%llu,\"ts\":%.3f,\"pid\":%d,\"tid\":%d}",
+                          stage == TraceStage::REQUEST_BEGIN ? "b" : "e", static_cast<unsigned long long>(trace),
+                          start / 1e3, pid, tid);
+        }
+        else if (stage == TraceStage::LOAD_STATE) {
+            std::snprintf(line, sizeof(line),
+                          ",\n{\"name\":\"%s\",\"cat\":\"stage\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%d,\"tid\":%d,"
+                          "\"args\":{\"request\":%llu,\"object\":%d}}",
+                          stageNames[static_cast<size_t>(stage)], start / 1e3, duration / 1e3, pid, tid,
+                          static_cast<unsigned long long>(trace), object);
+        }
+        else {
+            std::snprintf(line, sizeof(line),
+                          ",\n{\"name\":\"%s\",\"cat\":\"stage\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%d,\"tid\":%d,"
+                          "\"args\":{\"request\":%llu}}",
+                          stageNames[static_cast<size_t>(stage)], start / 1e3, duration / 1e3, pid, tid,
+                          static_cast<unsigned long long>(trace));
+        }
+        file << line;
+        written++;
+    }
+}
+
+bool dumpTrace() {
+    if (!isTracingEnabled()) {
+        std::cerr << color("warn") << "Tracing is off, start the server with --trace <n>.\n" << std::flush;
+        return false;
+    }
+
+    long long now = std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    std::filesystem::path path = std::filesystem::current_path() / (TRACE_FILE_PREFIX + std::to_string(now) + ".json");
+
+    std::ofstream file(path);
+    if (!file) {
+        std::cerr << color("error") << "Cannot write " << path << ".\n" << std::flush;
+        return false;
+    }
+
+    bool first = true;
+    size_t written = 0;
+    file << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    traceRings.forEach([&](const TraceRing& ring) { writeRingEvents(file, ring, first, written); });
+    if (workerPool) workerPool->forEachWorkerTrace([&](const TraceRing& ring) { writeRingEvents(file, ring, first, written); });
+    file << "\n]}\n";
+    file.close();
+
+    if (!file) {
+        std::cerr << color("error") << "Cannot write " << path << ".\n" << std::flush;
+        return false;
+    }
+    std::cout << color("log") << "Trace with " << written << " events written to " << path << "\n\n" << std::flush;
+    return true;
+}
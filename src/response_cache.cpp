@@ -0,0 +1,156 @@
+/*
+ *  Copyright 2025 Mendel Dobondi-Reisz
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+// C++ Standard Libraries
+#include <unordered_map>
+#include <string_view>
+#include <functional>
+#include <cstring>
+#include <cstdint>
+#include <string>
+#include <cmath>
+#include <mutex>
+#include <list>
+
+// Project Headers
+#include <response_cache.hpp>
+#include <spice_core.hpp>
+#include <utils.hpp>
+
+
+
+// ─────────────────────────────────────────────
+// Response Cache Key - quantized request
+// ─────────────────────────────────────────────
+
+bool ResponseCacheKey::operator==(const ResponseCacheKey& other) const {
+    return quantizedTime == other.quantizedTime && mode == other.mode && observerId == other.observerId;
+}
+
+size_t ResponseCacheKeyHash::operator()(const ResponseCacheKey& key) const {
+    size_t hash = std::hash<int64_t>()(key.quantizedTime);
+    hash ^= std::hash<int32_t>()(key.observerId) + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+    return hash ^ (static_cast<size_t>(key.mode) << 1);
+}
+
+bool isCacheableRequest(std::string_view request) {
+    if (request.size() != EXPECTED_MESSAGE_LENGTH) return false;
+    MessageMode mode = static_cast<MessageMode>(request[sizeof(SpiceDouble)] & ~MESSAGE_FLAG_TDB);
+    return mode == MessageMode::ALL_INSTANTANEOUS || mode == MessageMode::ALL_LIGHT_TIME_ADJUSTED;
+}
+
+bool makeResponseCacheKey(std::string_view request, ResponseCacheKey& key) {
+    if (!isCacheableRequest(request)) return false;
+
+    SpiceDouble utcTimestamp;
+    std::memcpy(&utcTimestamp, request.data(), sizeof(utcTimestamp));
+    if (!std::isfinite(utcTimestamp)) return false;
+
+    key.quantizedTime = std::llround(utcTimestamp / serverOptions.responseCacheQuantum);
+    key.mode = static_cast<uint8_t>(request[sizeof(utcTimestamp)]);
+    std::memcpy(&key.observerId, request.data() + sizeof(utcTimestamp) + sizeof(key.mode), sizeof(key.observerId));
+    return true;
+}
+
+void snapRequestTimestamp(std::string& request) {
+    ResponseCacheKey key;
+    if (!makeResponseCacheKey(request, key)) return;
+
+    SpiceDouble snapped = key.quantizedTime * serverOptions.responseCacheQuantum;
+    std::memcpy(request.data(), &snapped, sizeof(snapped));
+}
+
+
+
+// ─────────────────────────────────────────────
+// Response Cache - bounded LRU of serialized responses
+// ─────────────────────────────────────────────
+
+bool ResponseCache::lookup(std::string_view request, std::string& response) {
+    ResponseCacheKey key;
+    if (!makeResponseCacheKey(request, key)) return false;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = index.find(key);
+        if (it == index.end()) {
+            misses.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        entries.splice(entries.begin(), entries, it->second);
+        response = it->second->second;
+    }
+    hits.fetch_add(1, std::memory_order_relaxed);
+
+    // Echo the client's own timestamp unless the grid time is what it asked for
+    if (!serverOptions.responseCacheSnap) std::memcpy(response.data(), request.data(), sizeof(SpiceDouble));
+    return true;
+}
+
+void ResponseCache::insert(std::string_view request, std::string_view response, uint64_t generation) {
+    ResponseCacheKey key;
+    if (!makeResponseCacheKey(request, key)) return;
+    if (response.size() <= sizeof(SpiceDouble) || static_cast<uint8_t>(response[sizeof(SpiceDouble)]) != key.mode) return;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (generation != currentGeneration.load()) return;         // Computed with the previous kernel version
+
+    auto it = index.find(key);
+    if (it != index.end()) {
+        entries.splice(entries.begin(), entries, it->second);
+        return;
+    }
+
+    entries.emplace_front(key, std::string(response));
+    index.emplace(key, entries.begin());
+
+    while (entries.size() > serverOptions.responseCacheEntries) {
+        index.erase(entries.back().first);
+        entries.pop_back();
+    }
+}
+
+void ResponseCache::flush() {
+    std::lock_guard<std::mutex> lock(mutex);
+    currentGeneration.fetch_add(1);
+    index.clear();
+    entries.clear();
+}
+
+uint64_t ResponseCache::generation() const {
+    return currentGeneration.load();
+}
+
+ResponseCacheStats ResponseCache::stats() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return { hits.load(), misses.load(), entries.size() };
+}
+
+
+
+// ─────────────────────────────────────────────
+// Response Cache Instance
+// ─────────────────────────────────────────────
+
+ResponseCache responseCache;
+
+bool isResponseCacheEnabled() {
+    return serverOptions.responseCacheEntries > 0;
+}
+
+void flushResponseCache() {
+    responseCache.flush();
+}
@@ -0,0 +1,281 @@
+/*
+ *  Copyright 2025 Mendel Dobondi-Reisz
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+// C++ Standard Libraries
+#include <string_view>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <cmath>
+
+// External Libraries
+#include <zstd.h>
+
+// Project Headers
+#include <response_encoding.hpp>
+#include <spice_core.hpp>
+#include <utils.hpp>
+
+#define QUAT16_SCALE (32767.0 * 1.41421356237309504880)   // Smallest-three components lie within +-1/sqrt(2)
+
+
+
+// ─────────────────────────────────────────────
+// Encoding State - one per connection, loop thread only
+// ─────────────────────────────────────────────
+
+void EncodingState::reset() {
+    layout.clear();
+    previous.clear();
+}
+
+
+
+// ─────────────────────────────────────────────
+// Fixed-Width Values - key frames and the base of delta frames
+// ─────────────────────────────────────────────
+
+enum class WordCoding : uint8_t {
+    BITS,           // XOR with the previous bit pattern: close floats share sign, exponent and high mantissa
+    DIFFERENCE      // Zigzag difference of int16 values
+};
+
+struct Word {
+    uint8_t width;
+    WordCoding coding;
+};
+
+static void appendValue(std::string& values, double value, uint8_t encoding) {
+    if (encoding & ENCODING_FLOAT32) {
+        float narrowed = static_cast<float>(value);
+        values.append(reinterpret_cast<const char*>(&narrowed), sizeof(narrowed));
+    }
+    else values.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+static void appendQuaternion(std::string& values, const double q[4], uint8_t encoding) {
+    if (!(encoding & ENCODING_QUAT16)) {
+        for (int i = 0; i < 4; i++) appendValue(values, q[i], encoding);
+        return;
+    }
+
+    // q and -q are the same rotation: flip the largest component positive and leave it out
+    int largest = 0;
+    for (int i = 1; i < 4; i++) {
+        if (std::fabs(q[i]) > std::fabs(q[largest])) largest = i;
+    }
+    double norm = std::sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+    double scale = norm > 0.0 ? (q[largest] < 0.0 ? -QUAT16_SCALE : QUAT16_SCALE) / norm : 0.0;
+
+    values.push_back(static_cast<char>(largest));
+    for (int i = 0; i < 4; i++) {
+        if (i == largest) continue;
+        int16_t quantized = static_cast<int16_t>(std::clamp(std::lround(q[i] * scale), -32767L, 32767L));
+        values.append(reinterpret_cast<const char*>(&quantized), sizeof(quantized));
+    }
+}
+
+static void objectWords(uint8_t components, uint8_t encoding, std::vector<Word>& words) {
+    Word vectorWord = { static_cast<uint8_t>(encoding & ENCODING_FLOAT32 ? sizeof(float) : sizeof(double)), WordCoding::BITS };
+
+    words.clear();
+    if (components & COMPONENT_POSITION) words.insert(words.end(), 3, vectorWord);
+    if (components & COMPONENT_VELOCITY) words.insert(words.end(), 3, vectorWord);
+    if (components & COMPONENT_ORIENTATION) {
+        if (encoding & ENCODING_QUAT16) {
+            words.push_back({ 1, WordCoding::BITS });
+            words.insert(words.end(), 3, Word{ sizeof(int16_t), WordCoding::DIFFERENCE });
+        }
+        else words.insert(words.end(), 4, vectorWord);
+    }
+    if (components & COMPONENT_ANGULAR_VELOCITY) words.insert(words.end(), 3, vectorWord);
+}
+
+
+
+// ─────────────────────────────────────────────
+// Delta Coding - LEB128 varints against the previous frame
+// ─────────────────────────────────────────────
+
+static void appendVarint(std::string& frame, uint64_t value) {
+    while (value >= 0x80) {
+        frame.push_back(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    frame.push_back(static_cast<char>(value));
+}
+
+static uint64_t deltaWord(const char* current, const char* previous, const Word& word) {
+    uint64_t a = 0, b = 0;
+    std::memcpy(&a, current, word.width);
+    std::memcpy(&b, previous, word.width);
+
+    if (word.coding == WordCoding::BITS) return a ^ b;
+
+    int32_t difference = static_cast<int16_t>(a) - static_cast<int16_t>(b);
+    return (static_cast<uint32_t>(difference) << 1) ^ static_cast<uint32_t>(difference >> 31);
+}
+
+
+
+// ─────────────────────────────────────────────
+// Response Encoding
+// ─────────────────────────────────────────────
+
+uint8_t requestComponents(std::string_view request) {
+    if (request.size() != EXPECTED_MESSAGE_LENGTH + SELECTION_TRAILER_LENGTH) return COMPONENT_ALL;
+    return static_cast<uint8_t>(request.back()) & COMPONENT_ALL;
+}
+
+bool encodeResponse(std::string_view response, uint8_t components, EncodingState& state, std::string& frame) {
+    uint8_t encoding = state.encoding & ENCODING_VALUES;
+    if (!encoding || response.size() < sizeof(SpiceDouble) + 1) return false;
+
+    MessageMode mode = static_cast<MessageMode>(response[sizeof(SpiceDouble)] & ~MESSAGE_FLAG_TDB);
+    if (mode != MessageMode::ALL_INSTANTANEOUS && mode != MessageMode::ALL_LIGHT_TIME_ADJUSTED) return false;
+
+    size_t headerSize = sizeof(SpiceDouble) + 1;
+    size_t objectSize = objectDataSize(components);
+    if ((response.size() - headerSize) % objectSize != 0) return false;
+    size_t objectCount = (response.size() - headerSize) / objectSize;
+
+    // Scratch of the loop thread, swapped with the connection's buffers at the end, so no frame allocates
+    static thread_local std::string layout;
+    static thread_local std::string values;
+    static thread_local std::vector<Word> words;
+    layout.clear();
+    values.clear();
+
+    layout.push_back(response[sizeof(SpiceDouble)]);
+    layout.push_back(static_cast<char>(components));
+    layout.push_back(static_cast<char>(encoding));
+
+    for (size_t i = 0; i < objectCount; i++) {
+        const char* object = response.data() + headerSize + i * objectSize;
+        layout.append(object, sizeof(SpiceInt));
+
+        const char* cursor = object + sizeof(SpiceInt);
+        auto next = [&cursor]() {
+            double value;
+            std::memcpy(&value, cursor, sizeof(value));
+            cursor += sizeof(value);
+            return value;
+        };
+
+        if (components & COMPONENT_POSITION) for (int k = 0; k < 3; k++) appendValue(values, next(), encoding);
+        if (components & COMPONENT_VELOCITY) for (int k = 0; k < 3; k++) appendValue(values, next(), encoding);
+        if (components & COMPONENT_ORIENTATION) {
+            double q[4];
+            for (int k = 0; k < 4; k++) q[k] = next();
+            appendQuaternion(values, q, encoding);
+        }
+        if (components & COMPONENT_ANGULAR_VELOCITY) for (int k = 0; k < 3; k++) appendValue(values, next(), encoding);
+    }
+    size_t valuesPerObject = objectCount ? values.size() / objectCount : 0;
+
+    // A delta needs the same objects in the same layout as the previous frame, anything else is a key frame
+    bool delta = (encoding & ENCODING_DELTA) && layout == state.layout && values.size() == state.previous.size();
+
+    frame.assign(response.data(), headerSize);
+    frame.push_back(static_cast<char>(encoding | (delta ? ENCODING_DELTA_FRAME : 0)));
+
+    if (delta) {
+        objectWords(components, encoding, words);
+
+        size_t offset = 0;
+        for (size_t i = 0; i < objectCount; i++) {
+            for (const Word& word : words) {
+                appendVarint(frame, deltaWord(values.data() + offset, state.previous.data() + offset, word));
+                offset += word.width;
+            }
+        }
+    }
+    else {
+        frame.reserve(frame.size() + objectCount * sizeof(SpiceInt) + values.size());
+        for (size_t i = 0; i < objectCount; i++) {
+            frame.append(response.data() + headerSize + i * objectSize, sizeof(SpiceInt));
+            frame.append(values, i * valuesPerObject, valuesPerObject);
+        }
+    }
+
+    state.layout.swap(layout);
+    state.previous.swap(values);
+    return true;
+}
+
+
+
+// ─────────────────────────────────────────────
+// Frame Compression - shuffle + zstd, loop thread
+// ─────────────────────────────────────────────
+
+#define SHUFFLE_LANE sizeof(double)
+
+static void shuffleBytes(std::string_view input, std::string& output) {
+    size_t lanes = input.size() / SHUFFLE_LANE;
+    output.resize(input.size());
+
+    for (size_t byte = 0; byte < SHUFFLE_LANE; byte++) {
+        char* plane = output.data() + byte * lanes;
+        for (size_t i = 0; i < lanes; i++) plane[i] = input[i * SHUFFLE_LANE + byte];
+    }
+    std::memcpy(output.data() + lanes * SHUFFLE_LANE, input.data() + lanes * SHUFFLE_LANE, input.size() % SHUFFLE_LANE);
+}
+
+bool compressFrame(std::string_view frame, int level, std::string& compressed) {
+    static thread_local ZSTD_CCtx* context = ZSTD_createCCtx();     // One per loop thread, lives as long as it
+    static thread_local std::string shuffled;
+    if (!context || frame.size() < sizeof(double)) return false;
+
+    shuffleBytes(frame, shuffled);
+
+    uint32_t originalSize = static_cast<uint32_t>(frame.size());
+    compressed.resize(COMPRESSED_HEADER_SIZE + ZSTD_compressBound(shuffled.size()));
+    std::memcpy(compressed.data(), frame.data(), sizeof(double));   // The timestamp stays readable
+    compressed[sizeof(double)] = COMPRESSED_MODE;
+    std::memcpy(compressed.data() + sizeof(double) + 1, &originalSize, sizeof(originalSize));
+
+    size_t size = ZSTD_compressCCtx(context, compressed.data() + COMPRESSED_HEADER_SIZE, compressed.size() - COMPRESSED_HEADER_SIZE,
+                                    shuffled.data(), shuffled.size(), level);
+    if (ZSTD_isError(size) || COMPRESSED_HEADER_SIZE + size >= frame.size()) return false;
+
+    compressed.resize(COMPRESSED_HEADER_SIZE + size);
+    return true;
+}
+
+
+
+// ─────────────────────────────────────────────
+// Frame Serialization - loop thread
+// ─────────────────────────────────────────────
+
+std::string_view serializeFrame(std::string_view response, uint8_t components, EncodingState& state, bool& large) {
+    static thread_local std::string frame;                          // Both keep their capacity from frame to frame
+    static thread_local std::string compressed;
+
+    std::string_view payload = response;
+    if (encodeResponse(response, components, state, frame)) payload = frame;
+
+    // Real-time frames stay uncompressed, only bulk frames are worth the CPU
+    large = payload.size() >= serverOptions.compressThreshold;
+    if (large && (state.encoding & ENCODING_ZSTD) && compressFrame(payload, serverOptions.zstdLevel, compressed)) {
+        payload = compressed;
+        large = false;
+    }
+    return payload;
+}
@@ -16,18 +16,30 @@
  
 // Standard C++ Libraries
 #include <condition_variable>
+#include <unordered_map>
+#include <algorithm>
+#include <memory>
+#include <thread>
 #include <csignal>
 #include <chrono>
+#include <vector>
 #include <mutex>
+#include <deque>
 
 // External Libraries
 #include <uWebSockets/App.h>
 
 // Project Headers
 #include <websocket_manager.hpp>
+#include <compute_manager.hpp>
 #include <server_threads.hpp>
+#include <response_cache.hpp>
+#include <prefetch_manager.hpp>
 #include <data_manager.hpp>
+#include <worker_pool.hpp>
 #include <spice_core.hpp>
+#include <request_trace.hpp>
+#include <metrics.hpp>
 #include <utils.hpp>
 
 
@@ -41,6 +53,7 @@ void dataManagerWorker(int syncInterval) {
 
     if(dataManager.getLocalVersion() !=  NO_VERSION) {
         dataManager.makeSpiceDataAvailable();
+        dataManager.makeEphemerisSnapshotAvailable();           // Mapped from disk after a restart
     }
 
     while (true) {    
@@ -51,11 +64,37 @@ void dataManagerWorker(int syncInterval) {
             if(!dataManager.editTempVersionFile()) continue;        // Continue if editing version file failed
             if(!dataManager.deleteUnUsedFiles()) continue;          // Continue if deleting unneeded files failed
 
-            dataManager.makeSpiceDataUnavailable();                 // Notify webSocket thread then unload SPICE data
-            dataManager.moveFolder();                               // WebSocket responses are disabled while SPICE data is being updated.
-            dataManager.makeSpiceDataAvailable();                   // Load new SPICE data then notify webSocket thread
-            
+            if(!dataManager.moveFolder()) continue;                 // Install next to the loaded version, data/hera points at it
+
+            if(!dataManager.swapSpiceData()) {                      // Requests are served by the old kernels until the switch
+                if (dataManager.restorePreviousVersion()) dataManager.makeEphemerisSnapshotAvailable();
+                continue;
+            }
+            dataManager.deleteRetiredVersion();                     // Nothing has the previous version loaded anymore
             dataManager.deleteTmpFolder();                          // Delete the temporary folder
+            dataManager.makeEphemerisSnapshotAvailable();           // Written from the new kernels, then mapped
+        }
+
+        if (isResponseCacheEnabled()) {
+            ResponseCacheStats stats = responseCache.stats();
+            std::cout << color("log") << "Response cache: " << stats.hits << " hits, " << stats.misses
+                      << " misses, " << stats.entries << " entries.\n\n" << std::flush;
+        }
+        if (isPrefetchEnabled()) {
+            PrefetchStats stats = prefetchStats();
+            uint64_t requests = stats.hits + stats.misses;
+            std::cout << color("log") << "Prefetch: " << stats.hits << " hits, " << stats.misses << " misses ("
+                      << (requests ? 100 * stats.hits / requests : 0) << "% hit rate), " << stats.computed
+                      << " frames computed ahead.\n\n" << std::flush;
+        }
+        CoalescingStats coalescing = coalescingStats();
+        if (coalescing.coalesced) {
+            std::cout << color("log") << "Coalescing: " << coalescing.coalesced << " of " << coalescing.requests
+                      << " computed requests shared a computation (" << 100 * coalescing.coalesced / coalescing.requests
+                      << "%).\n\n" << std::flush;
+        }
+        if (droppedFrames.load()) {
+            std::cout << color("log") << "Backpressure: " << droppedFrames.load() << " frames dropped.\n\n" << std::flush;
         }
         
         std::unique_lock<std::mutex> lock(versionMutex);
@@ -74,27 +113,203 @@ void dataManagerWorker(int syncInterval) {
 
 
 
+// ─────────────────────────────────────────────
+// ComputeManagerWorker - SPICE Compute Thread
+// ─────────────────────────────────────────────
+
+void computeManagerWorker() {
+    if (workerPool) {
+        nameTraceThread("worker dispatcher");
+        workerPoolDispatcher(*workerPool);
+        return;
+    }
+
+    ComputeTask task;
+    std::string responseBuffer;                                     // Keeps its capacity from request to request
+    std::string swapResponse;
+    nameTraceThread("compute");
+
+    while (waitForComputeTask(task)) {
+        setCurrentTrace(task.trace);
+        traceStage(TraceStage::QUEUE, task.queuedAt);
+        uint64_t lockStart = traceStart();
+
+        std::unique_lock<std::mutex> lock(spiceMutex);
+        spiceCondition.wait(lock, [] {
+            return spiceDataAvailable.load() || !shouldComputeManagerRun.load();
+        });
+        if (!shouldComputeManagerRun.load()) break;                 // Exit if thread shutdown requested
+        traceStage(TraceStage::SPICE_MUTEX, lockStart);
+        recordStage(MetricsStage::QUEUE, task.queuedAt);            // Includes waiting for spiceMutex and SPICE data
+
+        // Kernel swap: the swap worker answers with the new version, or the request waits for the reload
+        if (spiceReloading) {
+            lock.unlock();
+            if (answerOnSwapWorker(task.request, task.trace, swapResponse)) {
+                uint64_t deliverStart = traceStart();
+                deliverResponse(task, std::move(swapResponse));
+                traceStage(TraceStage::DELIVER, deliverStart);
+                setCurrentTrace(0);
+                continue;
+            }
+            lock.lock();
+            spiceCondition.wait(lock, [] {
+                return !spiceReloading || !shouldComputeManagerRun.load();
+            });
+            if (!shouldComputeManagerRun.load()) break;
+        }
+
+        std::string_view response = processRequest(task.request, responseBuffer);
+        lock.unlock();
+
+        uint64_t deliverStart = traceStart();
+        deliverResponse(task, std::string(response));               // The loop gets an exactly sized copy
+        traceStage(TraceStage::DELIVER, deliverStart);
+        setCurrentTrace(0);
+    }
+
+    return;
+}
+
+void workerPoolDispatcher(WorkerPool& pool) {
+    std::deque<ComputeTask> backlog;                        // Waiting for a free ring slot or a ready worker
+    std::unordered_map<uint64_t, ComputeTask> pending;      // Submitted to a worker, keyed by tag
+    std::vector<uint64_t> lostTags;
+    uint64_t nextTag = 1;
+    int idleRounds = 0;
+
+    auto onResponse = [&](uint64_t tag, std::string&& response) {
+        auto it = pending.find(tag);
+        if (it == pending.end()) return;
+        setCurrentTrace(it->second.trace);
+        uint64_t start = traceStart();
+        deliverResponse(it->second, std::move(response));
+        traceStage(TraceStage::DELIVER, start);
+        setCurrentTrace(0);
+        pending.erase(it);
+    };
+
+    while (shouldComputeManagerRun.load()) {
+        if (backlog.empty() && pending.empty()) {           // Nothing in flight, sleep until a request arrives
+            ComputeTask task;
+            if (!waitForComputeTask(task)) break;
+            backlog.push_back(std::move(task));
+        }
+        takeComputeTasks(backlog);
+
+        // Prefetch only goes to workers that client requests leave idle
+        ComputeTask prefetchTask;
+        if (backlog.empty() && pending.size() < static_cast<size_t>(pool.readyWorkers()) && takePrefetchTask(prefetchTask)) {
+            backlog.push_back(std::move(prefetchTask));
+        }
+
+        bool progress = false;
+        while (!backlog.empty() && pool.submit(nextTag, backlog.front().request, backlog.front().trace)) {
+            recordStage(MetricsStage::QUEUE, backlog.front().queuedAt);     // Until a worker's ring took it
+            setCurrentTrace(backlog.front().trace);
+            traceStage(TraceStage::QUEUE, backlog.front().queuedAt);
+            setCurrentTrace(0);
+            pending.emplace(nextTag++, std::move(backlog.front()));
+            backlog.pop_front();
+            progress = true;
+        }
+        if (pool.poll(onResponse)) progress = true;
+
+        lostTags.clear();
+        pool.superviseWorkers(lostTags);
+        for (uint64_t tag : lostTags) {
+            auto it = pending.find(tag);
+            if (it == pending.end()) continue;
+            backlog.push_front(std::move(it->second));
+            pending.erase(it);
+        }
+
+        // Client requests in the backlog, or in a ring behind the request its worker computes, hold prefetch back
+        size_t waiting = 0, clients = 0;
+        for (const ComputeTask& task : backlog) waiting += !task.prefetch;
+        for (const auto& [tag, task] : pending) clients += !task.prefetch;
+        size_t ready = static_cast<size_t>(std::max(0, pool.readyWorkers()));
+        if (pending.size() > ready) waiting += std::min(clients, pending.size() - ready);
+        publishWorkerBacklog(waiting);
+
+        if (progress) idleRounds = 0;
+        else pollBackoff(idleRounds++);
+    }
+
+    return;
+}
+
+
+
 // ─────────────────────────────────────────────
 // WebSocketManagerWorker - uWebSockets Thread
 // ─────────────────────────────────────────────
 
 void webSocketManagerWorker(int port) {
+    int loopCount = std::max(1, serverOptions.loops);
+    {
+        std::lock_guard<std::mutex> lock(loopsMutex);
+        webSocketLoops.clear();
+        for (int i = 0; i < loopCount; i++) {
+            webSocketLoops.push_back(std::make_unique<WebSocketLoop>());
+            webSocketLoops.back()->index = i;
+        }
+    }
+
+    std::vector<std::thread> loopThreads;
+    for (int i = 1; i < loopCount; i++) loopThreads.emplace_back(webSocketLoopWorker, port, webSocketLoops[i].get());
+    webSocketLoopWorker(port, webSocketLoops[0].get());
+
+    for (auto& thread : loopThreads) {
+        if (thread.joinable()) thread.join();
+    }
+}
+
+void webSocketLoopWorker(int port, WebSocketLoop* state) {
+    currentLoop = state;
+    nameTraceThread(("loop " + std::to_string(state->index)).c_str());
+
+    // uSockets listens with SO_REUSEPORT: every loop binds the port, the kernel spreads the connections
     uWS::App threadApp;
+    if (serverOptions.metrics) {                            // Plain HTTP on the WebSocket port, any loop answers
+        threadApp.get(METRICS_ROUTE, [](uWS::HttpResponse<false>* response, uWS::HttpRequest*) {
+            response->writeHeader("Content-Type", METRICS_CONTENT_TYPE)->end(renderMetrics());
+        });
+    }
     threadApp.ws<UserData>(ENTRY_POINT, {
+        .compression = serverOptions.deflate ? uWS::SHARED_COMPRESSOR : uWS::DISABLED,
+        .maxBackpressure = static_cast<unsigned int>(serverOptions.maxBuffered + MAX_RANGE_FRAME_SIZE),  // Only bulk frames get here
         .open = onOpen,
         .message = onMessage,
+        .drain = onDrain,
         .close = onClose
-    }).listen(port, [port](us_listen_socket_t* socket) {
-        listenSocket = socket;
+    }).listen(port, [port, state](us_listen_socket_t* socket) {
+        state->listenSocket = socket;
         if (socket) {
-            std::cout << color("log") << "\nServer listening on port " << port << ".\n\n"
-                      << std::flush;
+            if (state->index == 0) {
+                std::cout << color("log") << "\nServer listening on port " << port << " with "
+                          << std::max(1, serverOptions.loops) << " event loop(s).\n\n" << std::flush;
+            }
         } else {
             std::cerr << color("error") << "\nFailed to listen on port " << port << ".\n\n"
                       << std::flush;
             exit(ERR_SOCKET_NULL);
         }
-    }).run();
+    });
+
+    {
+        std::lock_guard<std::mutex> lock(loopsMutex);
+        if (webSocketLoopsStopping) {                       // Shutdown came before this loop started
+            if (state->listenSocket) us_listen_socket_close(0, state->listenSocket);
+            state->listenSocket = nullptr;
+        }
+        else state->loop = uWS::Loop::get();
+    }
+
+    threadApp.run();
+
+    std::lock_guard<std::mutex> lock(loopsMutex);
+    state->loop = nullptr;                                  // The loop is freed with this thread
 }
 
 
@@ -105,22 +320,26 @@ void webSocketManagerWorker(int port) {
 
 std::atomic<bool> shuttingDown = false;
 std::thread* dataManagerPointer = nullptr;
+std::thread* computeManagerPointer = nullptr;
 std::thread* webSocketManagerPointer = nullptr;
 
-void gracefulShutdown(std::thread* dataManagerPointer, std::thread* webSocketManagerPointer) {
+void gracefulShutdown(std::thread* dataManagerPointer, std::thread* computeManagerPointer, std::thread* webSocketManagerPointer) {
     if (shuttingDown.exchange(true)) return;
 
     stopDataManagerWorker();
+    stopComputeManagerWorker();
+    if(computeManagerPointer->joinable()) computeManagerPointer->join();   // No deferred responses after the loop is gone
     stopWebSocketManagerWorker();
     if(dataManagerPointer->joinable()) dataManagerPointer->join();
     if(webSocketManagerPointer->joinable()) webSocketManagerPointer->join();
+    stopWorkerPool();
 
     std::cout << color("log") << "\nServer stopped gracefully!\n" << std::flush;
 }
 
 void handleSignal(int signal) {
     if (signal == SIGTERM) {
-        gracefulShutdown(dataManagerPointer, webSocketManagerPointer);
+        gracefulShutdown(dataManagerPointer, computeManagerPointer, webSocketManagerPointer);
         std::exit(SUCCESSFUL_EXIT);
     }
 }
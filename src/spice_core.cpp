@@ -16,8 +16,11 @@
 
 // Standard C++ Libraries
 #include <filesystem>
+#include <algorithm>
+#include <iterator>
 #include <iostream>
 #include <cstring>
+#include <vector>
 #include <cmath>
 
 // External Libraries
@@ -25,7 +28,10 @@
 
 // Project Headers
 #include <data_manager.hpp>
+#include <state_cache.hpp>
 #include <spice_core.hpp>
+#include <request_trace.hpp>
+#include <metrics.hpp>
 #include <utils.hpp>
 
 
@@ -34,69 +40,89 @@
 // Object Data - motion snapshots for objects
 // ─────────────────────────────────────────────
 
-ObjectData::ObjectData(SpiceDouble et, SpiceInt objectId, SpiceInt observerId, bool lightTimeAdjusted) {
+size_t objectDataSize(uint8_t components) {
+    size_t size = sizeof(SpiceInt);
+    if (components & COMPONENT_POSITION) size += sizeof(Vector);
+    if (components & COMPONENT_VELOCITY) size += sizeof(Vector);
+    if (components & COMPONENT_ORIENTATION) size += sizeof(Quaternion);
+    if (components & COMPONENT_ANGULAR_VELOCITY) size += sizeof(Vector);
+    return size;
+}
+
+ObjectData::ObjectData(SpiceDouble et, const CatalogObject& object, SpiceInt observerId, bool lightTimeAdjusted,
+                       uint8_t components, BarycentricTable* barycentric, const LightTimeEngine* lightTime) {
     this->et = et;
-    this->objectId = objectId;
+    this->objectId = object.id;
     this->observerId = observerId;
     this->lightTimeAdjusted = lightTimeAdjusted;
-    this->stateAvailable = loadState();
+    this->components = components;
+
+    uint64_t start = traceStart();
+    this->stateAvailable = loadState(object, barycentric, lightTime);
+    traceStage(TraceStage::LOAD_STATE, start, object.id);
 }
 
 void ObjectData::serializeToBinary(std::string& buffer) const {
     if (!stateAvailable) return;
 
-    buffer.reserve(buffer.size() + sizeof(objectId) + sizeof(objectState));
+    // Grows into reserved capacity, then one fixed-layout write
+    size_t offset = buffer.size();
+    buffer.resize(offset + objectDataSize(components));
+    char* out = buffer.data() + offset;
 
-    buffer.append(reinterpret_cast<const char*>(&objectId), sizeof(objectId));
-    buffer.append(reinterpret_cast<const char*>(&objectState.position), sizeof(objectState.position));
-    buffer.append(reinterpret_cast<const char*>(&objectState.velocity), sizeof(objectState.velocity));
-    buffer.append(reinterpret_cast<const char*>(&objectState.orientation), sizeof(objectState.orientation));
-    buffer.append(reinterpret_cast<const char*>(&objectState.angularVelocity), sizeof(objectState.angularVelocity));
-}
-
-bool ObjectData::loadState() {
-    std::string bodyFixedFrame = getBodyFixedFrameName(objectId);
-    if (bodyFixedFrame == "UNKNOWN") {
-        std::cerr << color("error") << "No valid frame found for ID: " << objectId
-                  << std::endl;
-        return stateAvailable = false;
+    std::memcpy(out, &objectId, sizeof(objectId));
+    out += sizeof(objectId);
+    if (components == COMPONENT_ALL) {
+        std::memcpy(out, &objectState, sizeof(objectState));
+        return;
     }
 
-    // Position and Velocity
+    if (components & COMPONENT_POSITION) {
+        std::memcpy(out, &objectState.position, sizeof(objectState.position));
+        out += sizeof(objectState.position);
+    }
+    if (components & COMPONENT_VELOCITY) {
+        std::memcpy(out, &objectState.velocity, sizeof(objectState.velocity));
+        out += sizeof(objectState.velocity);
+    }
+    if (components & COMPONENT_ORIENTATION) {
+        std::memcpy(out, &objectState.orientation, sizeof(objectState.orientation));
+        out += sizeof(objectState.orientation);
+    }
+    if (components & COMPONENT_ANGULAR_VELOCITY)
+        std::memcpy(out, &objectState.angularVelocity, sizeof(objectState.angularVelocity));
+}
 
-    SpiceDouble spiceState[6], lt;
-    std::string correctionMode = lightTimeAdjusted ? "LT+S" : "NONE";
-    spkez_c(objectId, et, "J2000", correctionMode.c_str(), observerId, spiceState, &lt);
+bool ObjectData::isAvailable() const {
+    return stateAvailable;
+}
 
-    if (failed_c()) { reset_c(); return stateAvailable = false; }
+bool ObjectData::loadState(const CatalogObject& object, BarycentricTable* barycentric, const LightTimeEngine* lightTime) {
+    // Reported once by buildObjectCatalog, not per request
+    if (!object.hasEphemeris || !object.hasOrientation) return stateAvailable = false;
 
-    objectState.position = { spiceState[0], spiceState[1], spiceState[2] };
-    objectState.velocity = { spiceState[3], spiceState[4], spiceState[5] };   
-   
-    // Quaternion and AngularVelocity
-  
-    SpiceDouble xform[6][6];
-    SpiceDouble correctedET = lightTimeAdjusted ? et - lt : et;
-    sxform_c(bodyFixedFrame.c_str(), "J2000", correctedET, xform);
-    
-    if (failed_c()) { reset_c(); return stateAvailable = false; }
-    
-    SpiceDouble rotationMatrix[3][3], quaternion[4], angularVelocity[3];
-    xf2rav_c(xform, rotationMatrix, angularVelocity);
-    m2q_c(rotationMatrix, quaternion);
+    const char* bodyFixedFrame = object.frameName.c_str();
+    if (isStateCacheEnabled() &&
+        stateCache.lookup(et, objectId, observerId, lightTimeAdjusted, bodyFixedFrame, objectState)) {
+        return stateAvailable = true;
+    }
 
-    /* 
-     *    SPICE quaternion order: w, x, y, z
-     * Three.js quaternion order: x, y, z, w
-     * 
-     *  We send quaternion as x, y, z, w to Three.js
+    /*
+     * Geometric states are differences of the SSB table, LT+S states come solved from the light time engine.
+     * Only the attitude is left for SPICE, at et - lt. Chains that only resolve below the SSB
+     * (common center without SSB coverage) fall through to spkez_c.
      */
-    objectState.orientation =
-        { quaternion[1], quaternion[2], quaternion[3], quaternion[0] };
-    objectState.angularVelocity =
-        { angularVelocity[0], angularVelocity[1], angularVelocity[2] };
+    SpiceDouble state[6], lt = 0.0;
+    bool solved = lightTimeAdjusted ? lightTime && lightTime->correctedState(object, state, lt)
+                                    : barycentric && barycentric->relativeState(object, observerId, state);
+    if (solved) {
+        objectState.position = { state[0], state[1], state[2] };
+        objectState.velocity = { state[3], state[4], state[5] };
+        return stateAvailable = computeMotionState(et - lt, objectId, observerId, false, bodyFixedFrame, objectState,
+                                                   components & (COMPONENT_ORIENTATION | COMPONENT_ANGULAR_VELOCITY));
+    }
 
-    return stateAvailable = true;
+    return stateAvailable = computeMotionState(et, objectId, observerId, lightTimeAdjusted, bodyFixedFrame, objectState, components);
 }
 
 
@@ -106,7 +132,15 @@ bool ObjectData::loadState() {
 // ─────────────────────────────────────────────
 
 void RequestHandler::setETime(SpiceDouble utcTimestamp) {
-    this->et = etTime(utcTimestamp);
+    uint64_t start = stageStart();
+    uint64_t traced = traceStart();
+    this->et = toEt(utcTimestamp);
+    recordStage(MetricsStage::UTC_TO_ET, start);
+    traceStage(TraceStage::UTC_TO_ET, traced);
+}
+
+SpiceDouble RequestHandler::toEt(SpiceDouble timestamp) const {
+    return tdbTimestamp ? timestamp : etTime(timestamp);
 }
 
 void RequestHandler::setMode(MessageMode mode) {
@@ -120,25 +154,130 @@ void RequestHandler::setObserverId(SpiceInt observerId) {
 int RequestHandler::writeHeader() {
     int size = message.size();
     message.append(reinterpret_cast<const char*>(&utcTimestamp), sizeof(utcTimestamp));
-    message.append(reinterpret_cast<const char*>(&mode), sizeof(mode));
+    uint8_t echoedMode = static_cast<uint8_t>(mode) | (tdbTimestamp ? MESSAGE_FLAG_TDB : 0);
+    message.append(reinterpret_cast<const char*>(&echoedMode), sizeof(echoedMode));
     if((message.size() - size) != 9) return 1;
     return 0;
 }
 
 int RequestHandler::writeData(SpiceBoolean lightTimeAdjusted) {
     int size = message.size();
-    for (const auto& [objectId, name] : objects) {
-        ObjectData obj(et, objectId, observerId, lightTimeAdjusted);
+    message.reserve(size + selectedObjectCount() * objectDataSize(componentMask));
+    BarycentricTable* barycentric = prepareBarycentricTable(et, lightTimeAdjusted);
+    const LightTimeEngine* lightTime = prepareLightTimeEngine(et, lightTimeAdjusted);
+    for (const CatalogObject& object : objectCatalog) {
+        if (!(objectMask >> object.index & 1)) continue;
+        ObjectData obj(et, object, observerId, lightTimeAdjusted, componentMask, barycentric, lightTime);
         obj.serializeToBinary(message);
     }
     if((message.size() - size) <= 0) return 1;
     return 0;
 }
 
-RequestHandler::RequestHandler(std::string_view incomingRequest) : request(incomingRequest) {    
+int RequestHandler::writeRangeData(SpiceBoolean lightTimeAdjusted) {
+    message.append(reinterpret_cast<const char*>(&sampleCount), sizeof(sampleCount));
+
+    // ET is linear in UTC across the range unless a leap second is crossed
+    SpiceDouble lastTimestamp = sampleTimestamp(sampleCount - 1);
+    bool linearEt = std::fabs((toEt(lastTimestamp) - et) - (lastTimestamp - utcTimestamp)) < 1e-3;
+
+    size_t objectsWritten = 0;
+    for (uint32_t i = 0; i < sampleCount; i++) {
+        SpiceDouble timestamp = sampleTimestamp(i);
+        SpiceDouble sampleEt = linearEt ? et + (timestamp - utcTimestamp) : toEt(timestamp);
+
+        message.append(reinterpret_cast<const char*>(&timestamp), sizeof(timestamp));
+        size_t countOffset = message.size();
+        message.push_back(0);
+
+        uint8_t objectCount = 0;
+        BarycentricTable* barycentric = prepareBarycentricTable(sampleEt, lightTimeAdjusted);
+        const LightTimeEngine* lightTime = prepareLightTimeEngine(sampleEt, lightTimeAdjusted);
+        for (const CatalogObject& object : objectCatalog) {
+            if (!(objectMask >> object.index & 1)) continue;
+            ObjectData obj(sampleEt, object, observerId, lightTimeAdjusted, componentMask, barycentric, lightTime);
+            if (!obj.isAvailable()) continue;
+            obj.serializeToBinary(message);
+            objectCount++;
+        }
+        message[countOffset] = static_cast<char>(objectCount);
+        objectsWritten += objectCount;
+    }
+
+    return objectsWritten ? 0 : 1;
+}
+
+bool RequestHandler::loadRange() {
+    if (request.size() < EXPECTED_RANGE_MESSAGE_LENGTH) return false;
+
+    size_t offset = sizeof(utcTimestamp) + sizeof(mode) + sizeof(observerId);
+    std::memcpy(&endTimestamp, request.data() + offset, sizeof(endTimestamp));
+    std::memcpy(&step, request.data() + offset + sizeof(endTimestamp), sizeof(step));
+
+    if (!std::isfinite(utcTimestamp) || !std::isfinite(endTimestamp) || !std::isfinite(step)) return false;
+    if (endTimestamp < utcTimestamp || step == 0.0) return false;
+
+    SpiceDouble samples = step > 0.0 ? std::floor((endTimestamp - utcTimestamp) / step) + 1.0 : std::round(-step);
+    if (samples < 1.0 || samples > MAX_RANGE_SAMPLES) return false;
+    sampleCount = static_cast<uint32_t>(samples);
+
+    size_t frameSize = sizeof(utcTimestamp) + sizeof(mode) + sizeof(sampleCount) +
+                       sampleCount * (sizeof(SpiceDouble) + sizeof(uint8_t) + selectedObjectCount() * objectDataSize(componentMask));
+    return frameSize <= MAX_RANGE_FRAME_SIZE;
+}
+
+BarycentricTable* RequestHandler::prepareBarycentricTable(SpiceDouble et, bool lightTimeAdjusted) const {
+    if (lightTimeAdjusted || !(componentMask & (COMPONENT_POSITION | COMPONENT_VELOCITY))) return nullptr;
+    uint64_t start = traceStart();
+    barycentricTable.prepare(et, objectMask);
+    traceStage(TraceStage::BARYCENTRIC_TABLE, start);
+    return &barycentricTable;
+}
+
+const LightTimeEngine* RequestHandler::prepareLightTimeEngine(SpiceDouble et, bool lightTimeAdjusted) const {
+    if (!lightTimeAdjusted) return nullptr;
+    uint64_t start = traceStart();
+    bool solved = lightTimeEngine.solve(et, observerId, objectMask);
+    traceStage(TraceStage::LIGHT_TIME_ENGINE, start);
+    return solved ? &lightTimeEngine : nullptr;
+}
+
+bool RequestHandler::loadSelection() {
+    size_t baseLength = isRangeMode(mode) ? EXPECTED_RANGE_MESSAGE_LENGTH : EXPECTED_MESSAGE_LENGTH;
+    if (request.size() == baseLength) return true;
+    if (request.size() != baseLength + SELECTION_TRAILER_LENGTH) return false;     // Another mode's length, e.g. a 38-byte 'i'
+
+    std::memcpy(&objectMask, request.data() + baseLength, sizeof(objectMask));
+    std::memcpy(&componentMask, request.data() + baseLength + sizeof(objectMask), sizeof(componentMask));
+    return objectMask != 0 && componentMask != 0 && !(componentMask & ~COMPONENT_ALL);
+}
+
+size_t RequestHandler::selectedObjectCount() const {
+    size_t count = 0;
+    for (const CatalogObject& object : objectCatalog) count += objectMask >> object.index & 1;
+    return count;
+}
+
+SpiceDouble RequestHandler::sampleTimestamp(uint32_t index) const {
+    if (step > 0.0) return utcTimestamp + index * step;
+    if (sampleCount == 1) return utcTimestamp;
+    return utcTimestamp + index * (endTimestamp - utcTimestamp) / (sampleCount - 1);
+}
+
+RequestHandler::RequestHandler(std::string_view incomingRequest) : RequestHandler(incomingRequest, ownMessage) {}
+
+RequestHandler::RequestHandler(std::string_view incomingRequest, std::string& responseBuffer)
+    : request(incomingRequest), message(responseBuffer) {
     std::memcpy(&utcTimestamp, request.data(), sizeof(utcTimestamp));
-    this->mode = static_cast<MessageMode>(request[sizeof(utcTimestamp)]);
+    uint8_t modeByte = static_cast<uint8_t>(request[sizeof(utcTimestamp)]);
+    this->mode = static_cast<MessageMode>(modeByte & ~MESSAGE_FLAG_TDB);
+    this->tdbTimestamp = modeByte & MESSAGE_FLAG_TDB;
     std::memcpy(&observerId, request.data() + sizeof(utcTimestamp) + sizeof(mode), sizeof(observerId));
+    this->endTimestamp = utcTimestamp;
+    this->step = 0.0;
+    this->sampleCount = 0;
+    this->objectMask = ~uint64_t(0);
+    this->componentMask = COMPONENT_ALL;
     this->setETime(utcTimestamp);
     this->clearMessage();
     this->writeMessage();
@@ -150,7 +289,27 @@ void RequestHandler::clearMessage() {
 
 int RequestHandler::writeMessage() {
     int error = writeHeader();
+
+    if (!loadSelection()) {
+        message[8] = (uint8_t)MessageMode::ERROR;
+        return -1;
+    }
     
+    if (isRangeMode(this->mode)) {
+        if (!loadRange()) {
+            message[8] = (uint8_t)MessageMode::ERROR;
+            return -1;
+        }
+
+        bool lightTimeAdjusted = mode == MessageMode::RANGE_LIGHT_TIME_ADJUSTED;
+        error |= writeRangeData(lightTimeAdjusted);
+        if(!error) return 0;
+
+        message.resize(sizeof(utcTimestamp) + sizeof(mode));   // Error responses carry the header only
+        message[8] = lightTimeAdjusted ? (uint8_t)MessageMode::ERROR_L : (uint8_t)MessageMode::ERROR_I;
+        return -1;
+    }
+
     if(this->mode != MessageMode::ALL_INSTANTANEOUS && this->mode != MessageMode::ALL_LIGHT_TIME_ADJUSTED) {
         message[8] = (uint8_t)MessageMode::ERROR;
         return -1;
@@ -164,16 +323,81 @@ int RequestHandler::writeMessage() {
     return -1;
 }
 
+bool isRangeMode(MessageMode mode) {
+    return mode == MessageMode::RANGE_INSTANTANEOUS || mode == MessageMode::RANGE_LIGHT_TIME_ADJUSTED;
+}
+
+bool isMultiRequest(std::string_view request) {
+    if (request.size() < MULTI_REQUEST_HEADER_LENGTH || request[0] != MULTI_REQUEST_COMMAND) return false;
+    size_t count = static_cast<uint8_t>(request[1]) & ~MULTI_REQUEST_CONCATENATE;
+    return count >= 1 && count <= MULTI_REQUEST_MAX &&
+           request.size() == MULTI_REQUEST_HEADER_LENGTH + count * EXPECTED_MESSAGE_LENGTH;
+}
+
+std::string_view processRequest(std::string_view request, std::string& responseBuffer) {
+    uint64_t start = traceStart();
+    if (!isMultiRequest(request)) {
+        RequestHandler requestHandler(request, responseBuffer);
+        traceStage(TraceStage::REQUEST_HANDLER, start);
+        return responseBuffer;
+    }
+
+    static thread_local std::string reply;                  // One reply at a time, keeps its capacity
+    responseBuffer.assign(request.data(), MULTI_REQUEST_HEADER_LENGTH);
+
+    // In request order, so the replies come back in the order the client packed them
+    for (size_t offset = MULTI_REQUEST_HEADER_LENGTH; offset < request.size(); offset += EXPECTED_MESSAGE_LENGTH) {
+        RequestHandler requestHandler(request.substr(offset, EXPECTED_MESSAGE_LENGTH), reply);
+        uint32_t length = static_cast<uint32_t>(reply.size());
+        responseBuffer.append(reinterpret_cast<const char*>(&length), sizeof(length));
+        responseBuffer.append(reply);
+    }
+    traceStage(TraceStage::REQUEST_HANDLER, start);
+    return responseBuffer;
+}
+
 std::string RequestHandler::getMessage() const {
     return message;
 }
 
+std::string_view RequestHandler::messageView() const {
+    return message;
+}
+
 bool kernelPathsLoaded = false;
 
 std::filesystem::path cremaMetakernel;
 std::filesystem::path operationalMetakernel;
 std::filesystem::path planMetakernel;
 
+LeapSecondTable leapSeconds;
+
+bool loadLeapSecondTable() {
+    SpiceInt count;
+    SpiceBoolean found;
+    SpiceDouble values[400];
+
+    leapSeconds.loaded = false;
+    leapSeconds.deltaAt.clear();
+
+    gdpool_c("DELTET/DELTA_T_A", 0, 1, &count, &leapSeconds.deltaTA, &found);
+    if (!found) return false;
+    gdpool_c("DELTET/K", 0, 1, &count, &leapSeconds.k, &found);
+    if (!found) return false;
+    gdpool_c("DELTET/EB", 0, 1, &count, &leapSeconds.eb, &found);
+    if (!found) return false;
+    gdpool_c("DELTET/M", 0, 2, &count, leapSeconds.m, &found);
+    if (!found || count != 2) return false;
+
+    // Pairs of (TAI - UTC, @epoch) - the pool stores @epochs as seconds past J2000
+    gdpool_c("DELTET/DELTA_AT", 0, 400, &count, values, &found);
+    if (!found || count < 2 || count % 2) return false;
+    for (SpiceInt i = 0; i < count; i += 2) leapSeconds.deltaAt.emplace_back(values[i + 1], values[i]);
+
+    if (failed_c()) { reset_c(); return false; }
+    return leapSeconds.loaded = true;
+}
+
 bool loadKernelPaths() {
     std::filesystem::path parentFolder = getExecutablePath().parent_path().parent_path();
 
@@ -200,13 +424,113 @@ void initSpiceCore() {
 
     erract_c("SET", 0, const_cast<SpiceChar*>("RETURN"));
     errprt_c("SET", 0, const_cast<SpiceChar*>("NONE"));
+
+    if (!loadLeapSecondTable()) {
+        std::cerr << color("warn") << "No leap second table in the kernel pool, using str2et_c for UTC.\n" << std::flush;
+    }
+    buildObjectCatalog();
+    invalidateBarycentricTable();
+    invalidateLightTimeEngine();
 }
 
 void deinitSpiceCore() {
     kclear_c();
+    leapSeconds.loaded = false;
+    clearObjectCatalog();
+    invalidateBarycentricTable();
+    invalidateLightTimeEngine();
+}
+
+bool computeMotionState(SpiceDouble et, SpiceInt objectId, SpiceInt observerId, bool lightTimeAdjusted,
+                        const char* bodyFixedFrame, MotionState& state, uint8_t components) {
+    const char* correction = lightTimeAdjusted ? "LT+S" : "NONE";
+    bool needsAttitude = components & (COMPONENT_ORIENTATION | COMPONENT_ANGULAR_VELOCITY);
+    SpiceDouble lt = 0.0;
+
+    // Position and Velocity - a position-only lookup when no velocity is wanted,
+    // and still needed for the light time of a corrected attitude
+
+    if (components & COMPONENT_VELOCITY) {
+        SpiceDouble spiceState[6];
+        uint64_t start = stageStart();
+        spkez_c(objectId, et, "J2000", correction, observerId, spiceState, &lt);
+        recordStage(MetricsStage::SPKEZ, start);
+        if (failed_c()) { reset_c(); return false; }
+
+        state.position = { spiceState[0], spiceState[1], spiceState[2] };
+        state.velocity = { spiceState[3], spiceState[4], spiceState[5] };
+    }
+    else if ((components & COMPONENT_POSITION) || (lightTimeAdjusted && needsAttitude)) {
+        SpiceDouble position[3];
+        uint64_t start = stageStart();
+        spkezp_c(objectId, et, "J2000", correction, observerId, position, &lt);
+        recordStage(MetricsStage::SPKEZ, start);
+        if (failed_c()) { reset_c(); return false; }
+
+        state.position = { position[0], position[1], position[2] };
+    }
+
+    if (!needsAttitude) return true;
+
+    // Quaternion and AngularVelocity - the 6x6 transform only when the rate is wanted
+
+    SpiceDouble correctedET = lightTimeAdjusted ? et - lt : et;
+    SpiceDouble rotationMatrix[3][3], quaternion[4], angularVelocity[3] = { 0.0, 0.0, 0.0 };
+    uint64_t start = stageStart();
+
+    if (components & COMPONENT_ANGULAR_VELOCITY) {
+        SpiceDouble xform[6][6];
+        sxform_c(bodyFixedFrame, "J2000", correctedET, xform);
+        recordStage(MetricsStage::SXFORM, start);
+        if (failed_c()) { reset_c(); return false; }
+
+        xf2rav_c(xform, rotationMatrix, angularVelocity);
+    }
+    else {
+        pxform_c(bodyFixedFrame, "J2000", correctedET, rotationMatrix);
+        recordStage(MetricsStage::SXFORM, start);
+        if (failed_c()) { reset_c(); return false; }
+    }
+    m2q_c(rotationMatrix, quaternion);
+
+    /* 
+     *    SPICE quaternion order: w, x, y, z
+     * Three.js quaternion order: x, y, z, w
+     * 
+     *  We send quaternion as x, y, z, w to Three.js
+     */
+    state.orientation =
+        { quaternion[1], quaternion[2], quaternion[3], quaternion[0] };
+    state.angularVelocity =
+        { angularVelocity[0], angularVelocity[1], angularVelocity[2] };
+
+    return true;
 }
 
 SpiceDouble etTime(SpiceDouble utcTimestamp) {
+    if (!leapSeconds.loaded) return etTimeFromString(utcTimestamp);
+    return etTimeFromTable(utcTimestamp, leapSeconds);
+}
+
+SpiceDouble etTimeFromTable(SpiceDouble utcTimestamp, const LeapSecondTable& table) {
+    // Unix time and SPICE's formal UTC calendar both ignore leap seconds: only the epoch differs
+    constexpr SpiceDouble J2000_UNIX_TIME = 946728000.0;    // 2000-01-01T12:00:00 UTC
+    SpiceDouble utc = utcTimestamp - J2000_UNIX_TIME;
+
+    // Same steps as deltet_c for UTC input
+    const auto& leaps = table.deltaAt;
+    auto leap = std::upper_bound(leaps.begin(), leaps.end(), utc,
+                                 [](SpiceDouble time, const auto& entry) { return time < entry.first; });
+    SpiceDouble deltaAt = leap == leaps.begin() ? leaps.front().second : std::prev(leap)->second;
+
+    SpiceDouble approximateEt = utc + deltaAt + table.deltaTA;
+    SpiceDouble meanAnomaly = table.m[0] + table.m[1] * approximateEt;
+    SpiceDouble eccentricAnomaly = meanAnomaly + table.eb * std::sin(meanAnomaly);
+
+    return utc + table.deltaTA + deltaAt + table.k * std::sin(eccentricAnomaly);
+}
+
+SpiceDouble etTimeFromString(SpiceDouble utcTimestamp) {
     SpiceDouble et;
     str2et_c(utcTimeString(utcTimestamp).c_str(), &et);
     return et;
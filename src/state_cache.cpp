@@ -0,0 +1,241 @@
+/*
+ *  Copyright 2025 Mendel Dobondi-Reisz
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+// C++ Standard Libraries
+#include <unordered_map>
+#include <functional>
+#include <cstdint>
+#include <vector>
+#include <cmath>
+#include <mutex>
+
+// External Libraries
+#include <cspice/SpiceUsr.h>
+
+// Project Headers
+#include <state_cache.hpp>
+#include <spice_core.hpp>
+#include <utils.hpp>
+
+
+
+// ─────────────────────────────────────────────
+// Chebyshev Helpers
+// ─────────────────────────────────────────────
+
+void chebyshevNodes(int degree, SpiceDouble* nodes) {
+    for (int k = 0; k <= degree; k++) {
+        nodes[k] = std::cos(M_PI * (k + 0.5) / (degree + 1));
+    }
+}
+
+void chebyshevFit(const SpiceDouble* values, int degree, SpiceDouble* coefficients) {
+    int count = degree + 1;
+    for (int j = 0; j < count; j++) {
+        SpiceDouble sum = 0.0;
+        for (int k = 0; k < count; k++) {
+            sum += values[k] * std::cos(M_PI * j * (k + 0.5) / count);
+        }
+        coefficients[j] = 2.0 * sum / count;
+    }
+    coefficients[0] *= 0.5;
+}
+
+SpiceDouble chebyshevEvaluate(const SpiceDouble* coefficients, int degree, SpiceDouble x) {
+    // Clenshaw recurrence
+    SpiceDouble b1 = 0.0, b2 = 0.0;
+    for (int j = degree; j >= 1; j--) {
+        SpiceDouble b0 = 2.0 * x * b1 - b2 + coefficients[j];
+        b2 = b1;
+        b1 = b0;
+    }
+    return x * b1 - b2 + coefficients[0];
+}
+
+
+
+// ─────────────────────────────────────────────
+// State Cache - Chebyshev fits of SPICE states
+// ─────────────────────────────────────────────
+
+static void packState(const MotionState& state, SpiceDouble* values) {
+    const SpiceDouble packed[STATE_COMPONENTS] = {
+        state.position.x, state.position.y, state.position.z,
+        state.velocity.x, state.velocity.y, state.velocity.z,
+        state.orientation.x, state.orientation.y, state.orientation.z, state.orientation.w,
+        state.angularVelocity.x, state.angularVelocity.y, state.angularVelocity.z
+    };
+    for (int i = 0; i < STATE_COMPONENTS; i++) values[i] = packed[i];
+}
+
+static void unpackState(const SpiceDouble* values, MotionState& state) {
+    SpiceDouble norm = std::sqrt(values[6] * values[6] + values[7] * values[7] +
+                                 values[8] * values[8] + values[9] * values[9]);
+
+    state.position = { values[0], values[1], values[2] };
+    state.velocity = { values[3], values[4], values[5] };
+    state.orientation = { values[6] / norm, values[7] / norm, values[8] / norm, values[9] / norm };
+    state.angularVelocity = { values[10], values[11], values[12] };
+}
+
+static SpiceDouble distance(const SpiceDouble* a, const SpiceDouble* b) {
+    return std::sqrt((a[0] - b[0]) * (a[0] - b[0]) + (a[1] - b[1]) * (a[1] - b[1]) + (a[2] - b[2]) * (a[2] - b[2]));
+}
+
+static bool withinTolerance(const SpiceDouble* fitted, const SpiceDouble* exact, SpiceDouble positionTolerance) {
+    SpiceDouble angleTolerance = STATE_CACHE_ANGLE_TOLERANCE;
+
+    if (distance(fitted, exact) > positionTolerance) return false;
+    if (distance(fitted + 3, exact + 3) > positionTolerance * STATE_CACHE_RATE_SCALE) return false;
+    if (distance(fitted + 10, exact + 10) > angleTolerance * STATE_CACHE_RATE_SCALE) return false;
+
+    // Rotation angle between the two (normalized) quaternions, sign-independent
+    SpiceDouble norm = std::sqrt(fitted[6] * fitted[6] + fitted[7] * fitted[7] + fitted[8] * fitted[8] + fitted[9] * fitted[9]);
+    SpiceDouble dot = (fitted[6] * exact[6] + fitted[7] * exact[7] + fitted[8] * exact[8] + fitted[9] * exact[9]) / norm;
+    return 2.0 * std::acos(std::min(1.0, std::fabs(dot))) <= angleTolerance;
+}
+
+bool fitStateSegment(SpiceDouble start, SpiceDouble end, SpiceInt objectId, SpiceInt observerId, bool lightTimeAdjusted,
+                     const char* bodyFixedFrame, SpiceDouble tolerance,
+                     SpiceDouble coefficients[STATE_COMPONENTS][STATE_CACHE_DEGREE + 1]) {
+    SpiceDouble nodes[STATE_CACHE_DEGREE + 1];
+    SpiceDouble samples[STATE_COMPONENTS][STATE_CACHE_DEGREE + 1];
+    chebyshevNodes(STATE_CACHE_DEGREE, nodes);
+
+    SpiceDouble middle = 0.5 * (start + end), half = 0.5 * (end - start);
+
+    // Sample SPICE at the Chebyshev nodes
+    for (int k = 0; k <= STATE_CACHE_DEGREE; k++) {
+        MotionState state;
+        SpiceDouble values[STATE_COMPONENTS];
+        if (!computeMotionState(middle + half * nodes[k], objectId, observerId, lightTimeAdjusted, bodyFixedFrame, state)) {
+            return false;
+        }
+        packState(state, values);
+
+        // q and -q are the same rotation: keep the samples on one hemisphere so they interpolate
+        if (k > 0) {
+            SpiceDouble dot = 0.0;
+            for (int i = 6; i < 10; i++) dot += values[i] * samples[i][k - 1];
+            if (dot < 0.0) for (int i = 6; i < 10; i++) values[i] = -values[i];
+        }
+        for (int i = 0; i < STATE_COMPONENTS; i++) samples[i][k] = values[i];
+    }
+
+    for (int i = 0; i < STATE_COMPONENTS; i++) chebyshevFit(samples[i], STATE_CACHE_DEGREE, coefficients[i]);
+
+    // Check the fit halfway between the nodes, where the interpolation error peaks
+    static const SpiceDouble checkpoints[] = { -0.9, -0.5, 0.0, 0.5, 0.9 };
+    for (SpiceDouble x : checkpoints) {
+        MotionState state;
+        SpiceDouble exact[STATE_COMPONENTS], fitted[STATE_COMPONENTS];
+        if (!computeMotionState(middle + half * x, objectId, observerId, lightTimeAdjusted, bodyFixedFrame, state)) {
+            return false;
+        }
+        packState(state, exact);
+        for (int i = 0; i < STATE_COMPONENTS; i++) fitted[i] = chebyshevEvaluate(coefficients[i], STATE_CACHE_DEGREE, x);
+        if (!withinTolerance(fitted, exact, tolerance)) return false;
+    }
+    return true;
+}
+
+void evaluateStateSegment(const SpiceDouble coefficients[STATE_COMPONENTS][STATE_CACHE_DEGREE + 1],
+                          SpiceDouble x, MotionState& state) {
+    SpiceDouble values[STATE_COMPONENTS];
+    for (int i = 0; i < STATE_COMPONENTS; i++) values[i] = chebyshevEvaluate(coefficients[i], STATE_CACHE_DEGREE, x);
+    unpackState(values, state);
+}
+
+void StateCache::fitSegment(SpiceDouble start, SpiceDouble end, int depth, SpiceInt objectId, SpiceInt observerId,
+                            bool lightTimeAdjusted, const char* bodyFixedFrame, std::vector<StateSegment>& segments) {
+    StateSegment segment;
+    segment.start = start;
+    segment.end = end;
+    segment.valid = fitStateSegment(start, end, objectId, observerId, lightTimeAdjusted, bodyFixedFrame,
+                                    serverOptions.stateCacheTolerance, segment.coefficients);
+
+    if (segment.valid || depth >= STATE_CACHE_MAX_DEPTH) {
+        segments.push_back(segment);
+        return;
+    }
+
+    // Slews, maneuvers and coverage gaps: bisect until the halves fit or get too short
+    SpiceDouble middle = 0.5 * (start + end);
+    fitSegment(start, middle, depth + 1, objectId, observerId, lightTimeAdjusted, bodyFixedFrame, segments);
+    fitSegment(middle, end, depth + 1, objectId, observerId, lightTimeAdjusted, bodyFixedFrame, segments);
+}
+
+bool StateCache::lookup(SpiceDouble et, SpiceInt objectId, SpiceInt observerId, bool lightTimeAdjusted,
+                        const char* bodyFixedFrame, MotionState& state) {
+    SpiceDouble windowLength = serverOptions.stateCacheWindow;
+    StateCacheKey key = { objectId, observerId, lightTimeAdjusted, static_cast<int64_t>(std::floor(et / windowLength)) };
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto it = windows.find(key);
+    if (it == windows.end()) {
+        if (windows.size() >= STATE_CACHE_MAX_WINDOWS) windows.clear();
+
+        std::vector<StateSegment> segments;
+        SpiceDouble start = key.window * windowLength;
+        fitSegment(start, start + windowLength, 0, objectId, observerId, lightTimeAdjusted, bodyFixedFrame, segments);
+        it = windows.emplace(key, std::move(segments)).first;
+    }
+
+    for (const StateSegment& segment : it->second) {
+        if (et < segment.start || et > segment.end) continue;
+        if (!segment.valid) return false;
+
+        SpiceDouble x = (2.0 * et - segment.start - segment.end) / (segment.end - segment.start);
+        evaluateStateSegment(segment.coefficients, x, state);
+        return true;
+    }
+
+    return false;
+}
+
+void StateCache::invalidate() {
+    std::lock_guard<std::mutex> lock(mutex);
+    windows.clear();
+}
+
+bool StateCacheKey::operator==(const StateCacheKey& other) const {
+    return objectId == other.objectId && observerId == other.observerId &&
+           lightTimeAdjusted == other.lightTimeAdjusted && window == other.window;
+}
+
+size_t StateCacheKeyHash::operator()(const StateCacheKey& key) const {
+    size_t hash = std::hash<int64_t>()(key.window);
+    hash ^= std::hash<SpiceInt>()(key.objectId) + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+    hash ^= std::hash<SpiceInt>()(key.observerId) + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+    return hash ^ static_cast<size_t>(key.lightTimeAdjusted);
+}
+
+
+
+// ─────────────────────────────────────────────
+// State Cache Instance
+// ─────────────────────────────────────────────
+
+StateCache stateCache;
+
+bool isStateCacheEnabled() {
+    return serverOptions.stateCacheTolerance > 0.0;
+}
+
+void invalidateStateCache() {
+    stateCache.invalidate();
+}
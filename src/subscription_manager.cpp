@@ -0,0 +1,207 @@
+/*
+ *  Copyright 2025 Mendel Dobondi-Reisz
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+// C++ Standard Libraries
+#include <unordered_map>
+#include <string_view>
+#include <iostream>
+#include <cstring>
+#include <cstdint>
+#include <chrono>
+#include <string>
+#include <cmath>
+
+// External Libraries
+#include <uWebSockets/App.h>
+
+// Project Headers
+#include <subscription_manager.hpp>
+#include <websocket_manager.hpp>
+#include <spice_core.hpp>
+#include <utils.hpp>
+
+
+
+// ─────────────────────────────────────────────
+// Subscription - simulation clock of one connection
+// ─────────────────────────────────────────────
+
+double Subscription::epoch(Clock::time_point now) const {
+    if (paused) return anchorEpoch;
+    return anchorEpoch + rate * std::chrono::duration<double>(now - anchorTime).count();
+}
+
+// Every loop thread ticks its own connections, nothing here is shared between loops
+static thread_local std::unordered_map<WS*, Subscription> subscriptions;
+static thread_local us_timer_t* subscriptionTimer = nullptr;
+static thread_local uint64_t nextSerial = 1;
+static thread_local uint64_t serialBase = 0;                    // Loop index in the top bits keeps serials unique across loops
+
+static void sendSubscriptionError(WS* ws, double timestamp, uWS::OpCode opCode) {
+    char reply[sizeof(double) + 1];
+    std::memcpy(reply, &timestamp, sizeof(timestamp));
+    reply[sizeof(timestamp)] = static_cast<char>(MessageMode::ERROR);
+    ws->send(std::string_view(reply, sizeof(reply)), opCode);
+}
+
+
+
+// ─────────────────────────────────────────────
+// Frame Timer - one per loop, only while subscriptions exist
+// ─────────────────────────────────────────────
+
+static void pushFrame(WS* ws, Subscription& subscription, Subscription::Clock::time_point now) {
+    double epoch = subscription.epoch(now);
+    std::string request = subscription.request;
+    std::memcpy(request.data(), &epoch, sizeof(epoch));
+
+    subscription.inFlight = true;
+    subscription.frames++;
+    if (dispatchRequest(ws, std::move(request), subscription.opCode, subscription.serial)) {
+        subscription.inFlight = false;                          // Answered from the response cache
+    }
+}
+
+static void onSubscriptionTick(us_timer_t*) {
+    auto now = Subscription::Clock::now();
+
+    for (auto& [ws, subscription] : subscriptions) {
+        if (subscription.paused || now < subscription.nextFrame) continue;
+
+        // A slow client or backend loses ticks instead of building up a queue
+        if (subscription.inFlight || ws->getBufferedAmount() > serverOptions.maxBuffered) subscription.skipped++;
+        else pushFrame(ws, subscription, now);
+
+        subscription.nextFrame += subscription.period;
+        if (subscription.nextFrame <= now) subscription.nextFrame = now + subscription.period;
+    }
+}
+
+static void updateSubscriptionTimer() {
+    if (!subscriptions.empty() && !subscriptionTimer) {
+        subscriptionTimer = us_create_timer(reinterpret_cast<us_loop_t*>(uWS::Loop::get()), 0, 0);
+        us_timer_set(subscriptionTimer, onSubscriptionTick, SUBSCRIPTION_TICK_MS, SUBSCRIPTION_TICK_MS);
+    }
+    else if (subscriptions.empty() && subscriptionTimer) {
+        us_timer_close(subscriptionTimer);                      // An open timer would keep the loop from exiting
+        subscriptionTimer = nullptr;
+    }
+}
+
+
+
+// ─────────────────────────────────────────────
+// Subscription Handlers - loop thread only
+// ─────────────────────────────────────────────
+
+static bool subscribe(WS* ws, std::string_view message, uWS::OpCode opCode) {
+    uint8_t mode = static_cast<uint8_t>(message[1]);
+    int32_t observerId;
+    double start, rate, frameRate;
+    std::memcpy(&observerId, message.data() + 2, sizeof(observerId));
+    std::memcpy(&start, message.data() + 6, sizeof(start));
+    std::memcpy(&rate, message.data() + 14, sizeof(rate));
+    std::memcpy(&frameRate, message.data() + 22, sizeof(frameRate));
+
+    MessageMode baseMode = static_cast<MessageMode>(mode & ~MESSAGE_FLAG_TDB);
+    bool valid = (baseMode == MessageMode::ALL_INSTANTANEOUS || baseMode == MessageMode::ALL_LIGHT_TIME_ADJUSTED) &&
+                 std::isfinite(start) && std::isfinite(rate) &&
+                 frameRate > 0.0 && frameRate <= SUBSCRIPTION_MAX_FRAME_RATE;
+    if (!valid) {
+        sendSubscriptionError(ws, start, opCode);
+        return true;
+    }
+
+    // Frames are ordinary requests: timestamp, mode, observer and the optional selection trailer
+    std::string request(EXPECTED_MESSAGE_LENGTH, '\0');
+    request[sizeof(double)] = static_cast<char>(mode);
+    std::memcpy(request.data() + sizeof(double) + 1, &observerId, sizeof(observerId));
+    request.append(message.substr(SUBSCRIBE_MESSAGE_LENGTH));
+
+    if (serialBase == 0) serialBase = static_cast<uint64_t>(currentLoop->index + 1) << 48;
+    auto now = Subscription::Clock::now();
+
+    Subscription& subscription = subscriptions[ws];
+    subscription = Subscription{};
+    subscription.serial = serialBase | nextSerial++;
+    subscription.session = ws->getUserData()->session;
+    subscription.request = std::move(request);
+    subscription.opCode = opCode;
+    subscription.anchorEpoch = start;
+    subscription.anchorTime = now;
+    subscription.rate = rate;
+    subscription.period = std::chrono::duration_cast<Subscription::Clock::duration>(std::chrono::duration<double>(1.0 / frameRate));
+    subscription.nextFrame = now;
+
+    updateSubscriptionTimer();
+    pushFrame(ws, subscription, now);                           // First frame right away, not one tick later
+    subscription.nextFrame = now + subscription.period;
+    return true;
+}
+
+bool handleSubscriptionMessage(WS* ws, std::string_view message, uWS::OpCode opCode) {
+    if (message.empty()) return false;
+    SubscriptionCommand command = static_cast<SubscriptionCommand>(message[0]);
+
+    if (command == SubscriptionCommand::SUBSCRIBE && (message.length() == SUBSCRIBE_MESSAGE_LENGTH ||
+        message.length() == SUBSCRIBE_MESSAGE_LENGTH + SELECTION_TRAILER_LENGTH)) {
+        return subscribe(ws, message, opCode);
+    }
+    if (message.length() != SUBSCRIPTION_CONTROL_LENGTH) return false;
+
+    auto it = subscriptions.find(ws);
+    auto now = Subscription::Clock::now();
+    switch (command) {
+        case SubscriptionCommand::UNSUBSCRIBE:
+            endSubscription(ws);
+            return true;
+        case SubscriptionCommand::PAUSE:
+            if (it == subscriptions.end()) break;
+            it->second.anchorEpoch = it->second.epoch(now);
+            it->second.paused = true;
+            return true;
+        case SubscriptionCommand::RESUME:
+            if (it == subscriptions.end()) break;
+            it->second.anchorTime = now;
+            it->second.paused = false;
+            it->second.nextFrame = now;
+            return true;
+        default:
+            return false;
+    }
+
+    sendSubscriptionError(ws, 0.0, opCode);                     // Pause or resume without a subscription
+    return true;
+}
+
+void endSubscription(WS* ws) {
+    auto it = subscriptions.find(ws);
+    if (it == subscriptions.end()) return;
+
+    std::cout << color("log")
+              << "Subscription ended for ID:   [" << ws->getUserData()->id << "] "
+              << it->second.frames << " frames, " << it->second.skipped << " skipped\n\n" << std::flush;
+
+    subscriptions.erase(it);
+    updateSubscriptionTimer();
+}
+
+bool completeSubscriptionFrame(WS* ws, uint64_t serial) {
+    auto it = subscriptions.find(ws);
+    if (it == subscriptions.end() || it->second.serial != serial) return false;
+    it->second.inFlight = false;
+    return true;
+}
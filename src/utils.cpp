@@ -21,6 +21,7 @@
 // Project headers
 #include <utils.hpp>
 #include <server_threads.hpp>
+#include <request_trace.hpp>
 
 
 
@@ -51,10 +52,128 @@ void loadValues(int argc, char** argv, int& port, int& syncInterval) {
     std::exit(ERR_INVALID_ARGUMENTS);
 }
 
+ServerOptions serverOptions;
+
+void loadOptions(int argc, char** argv, ServerOptions& options, int firstOption) {
+    try {
+        for (int i = firstOption; i < argc; i++) {
+            std::string option = argv[i];
+            bool hasValue = i + 1 < argc;
+
+            if (option == "--response-snap") {
+                options.responseCacheSnap = true;
+                continue;
+            }
+            if (option == "--deflate") {
+                options.deflate = true;
+                continue;
+            }
+            if (option == "--metrics") {
+                options.metrics = true;
+                continue;
+            }
+
+            if (option == "--workers" && hasValue) {
+                int tmp = std::stoi(argv[++i]);
+                options.workers = tmp > 0 ? tmp : 0;
+                continue;
+            }
+            if (option == "--loops" && hasValue) {
+                int tmp = std::stoi(argv[++i]);
+                options.loops = tmp > 1 ? tmp : 1;
+                continue;
+            }
+            if (option == "--state-cache" && hasValue) {
+                double tmp = std::stod(argv[++i]);
+                options.stateCacheTolerance = tmp > 0 ? tmp : 0;
+                continue;
+            }
+            if (option == "--state-cache-window" && hasValue) {
+                double tmp = std::stod(argv[++i]);
+                options.stateCacheWindow = tmp >= 1 ? tmp : 1;
+                continue;
+            }
+            if (option == "--response-cache" && hasValue) {
+                long long tmp = std::stoll(argv[++i]);
+                options.responseCacheEntries = tmp > 0 ? static_cast<size_t>(tmp) : 0;
+                continue;
+            }
+            if (option == "--response-quantum" && hasValue) {
+                double tmp = std::stod(argv[++i]);
+                options.responseCacheQuantum = tmp > 1e-6 ? tmp : 1e-6;
+                continue;
+            }
+            if (option == "--compress-threshold" && hasValue) {
+                long long tmp = std::stoll(argv[++i]);
+                options.compressThreshold = tmp > 0 ? static_cast<size_t>(tmp) : 0;
+                continue;
+            }
+            if (option == "--zstd-level" && hasValue) {
+                int tmp = std::stoi(argv[++i]);
+                options.zstdLevel = tmp < 1 ? 1 : (tmp > 19 ? 19 : tmp);
+                continue;
+            }
+            if (option == "--max-buffered" && hasValue) {
+                long long tmp = std::stoll(argv[++i]);
+                options.maxBuffered = tmp > 0 ? static_cast<size_t>(tmp) : 0;
+                continue;
+            }
+            if (option == "--snapshot" && hasValue) {
+                double tmp = std::stod(argv[++i]);
+                options.snapshotSegment = tmp > 0 ? tmp : 0;
+                continue;
+            }
+            if (option == "--trace" && hasValue) {
+                int tmp = std::stoi(argv[++i]);
+                options.traceSampling = tmp > 0 ? tmp : 0;
+                continue;
+            }
+            if (option == "--prefetch" && hasValue) {
+                int tmp = std::stoi(argv[++i]);
+                options.prefetchDepth = tmp > 0 ? tmp : 0;
+                continue;
+            }
+            if (option == "--catalog" && hasValue) {
+                options.catalogPath = argv[++i];
+                continue;
+            }
+
+            std::cerr << color("error") << "\nError: Unknown option or missing value: " << option << "\n";
+            printUsage(argv);
+            std::exit(ERR_INVALID_ARGUMENTS);
+        }
+        return;
+    } catch (const std::invalid_argument& e) {
+        std::cerr << color("error") << "\nError: Option values must be valid numbers.\n";
+
+    } catch (const std::out_of_range& e) {
+        std::cerr << color("error") << "\nError: Option value out of range.\n";
+    }
+    printUsage(argv);
+    std::exit(ERR_INVALID_ARGUMENTS);
+}
+
 void printUsage(char** argv) {
-    std::cerr << color("reset") << "Usage: " << argv[0] << " <port> <syncInterval>\n";
+    std::cerr << color("reset") << "Usage: " << argv[0] << " <port> <syncInterval> [options]\n";
     std::cerr << "<port>         - The port number to run the server on.\n";
     std::cerr << "<syncInterval> - The interval (in seconds) between kernel version checks.\n";
+    std::cerr << "Options:\n";
+    std::cerr << "--workers <n>               - Run SPICE in <n> worker processes (default: 0, in-process).\n";
+    std::cerr << "--loops <n>                 - Serve WebSockets from <n> event loop threads on the same port (default: 1).\n";
+    std::cerr << "--state-cache <km>          - Answer from cached Chebyshev fits within <km> (default: off).\n";
+    std::cerr << "--state-cache-window <s>    - Length of one state cache window in seconds (default: 3600).\n";
+    std::cerr << "--response-cache <entries>  - Keep up to <entries> serialized responses in an LRU cache (default: off).\n";
+    std::cerr << "--response-quantum <s>      - Time quantum of the response cache key in seconds (default: 0.001).\n";
+    std::cerr << "--response-snap             - Compute and echo the quantized time instead of the requested one.\n";
+    std::cerr << "--catalog <file>            - Serve the objects listed in <file> instead of the built-in list.\n";
+    std::cerr << "--deflate                   - Offer permessage-deflate for frames above the compression threshold.\n";
+    std::cerr << "--compress-threshold <b>    - Never compress frames below <b> bytes (default: 4096).\n";
+    std::cerr << "--zstd-level <n>            - zstd level for connections that negotiated zstd (default: 3).\n";
+    std::cerr << "--max-buffered <b>          - Hold back real-time frames while <b> bytes are unsent (default: 65536).\n";
+    std::cerr << "--prefetch <frames>         - Compute up to <frames> (max 8) of steady request streams ahead (default: off).\n";
+    std::cerr << "--snapshot <s>              - Answer 'i' requests from an ephemeris snapshot of <s> second segments, lengthened to fit 2 GiB (default: off).\n";
+    std::cerr << "--metrics                   - Serve Prometheus metrics with per-stage latency histograms on /metrics.\n";
+    std::cerr << "--trace <n>                 - Trace the stages of one in <n> requests, written by the `trace` command (default: off).\n";
 }
 
 void printTitle() {
@@ -72,6 +191,9 @@ void printTitle() {
 
 void printExitOption() {
     std::cout << color("info") << "\nType `exit` to stop the server!" << color("log") << std::endl;
+    if (isTracingEnabled()) {
+        std::cout << color("info") << "Type `" TRACE_COMMAND "` to write the sampled request traces!" << color("log") << std::endl;
+    }
 }
 
 std::string color(const std::string type) {
@@ -88,6 +210,7 @@ void waitForExitCommand() {
     while (!shuttingDown.load()) {
         std::cin >> command;
         if (command == "exit") break;
+        if (command == TRACE_COMMAND) dumpTrace();
         std::this_thread::sleep_for(std::chrono::milliseconds(250));
     }
 }
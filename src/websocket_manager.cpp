@@ -19,6 +19,8 @@
 #include <unordered_set>
 #include <string_view>
 #include <iostream>
+#include <cstring>
+#include <string>
 #include <cstdint>
 #include <atomic>
 #include <mutex>
@@ -29,7 +31,15 @@
 
 // Project Headers
 #include <websocket_manager.hpp>
+#include <compute_manager.hpp>
+#include <response_cache.hpp>
+#include <response_encoding.hpp>
+#include <ephemeris_snapshot.hpp>
+#include <subscription_manager.hpp>
+#include <prefetch_manager.hpp>
 #include <spice_core.hpp>
+#include <request_trace.hpp>
+#include <metrics.hpp>
 #include <utils.hpp>
 
 
@@ -41,6 +51,7 @@
 std::mutex spiceMutex;
 std::condition_variable spiceCondition;
 std::atomic<bool> spiceDataAvailable = false;
+bool spiceReloading = false;
 
 
 
@@ -76,8 +87,23 @@ ConnectionIDAllocator idAllocator;
 // WebSocket Connection Data
 // ─────────────────────────────────────────────
 
-std::mutex socketMutex;
-std::unordered_set<uWS::WebSocket<false, true, UserData>*> activeSockets;
+std::atomic<uint64_t> nextSession = 1;
+std::atomic<uint64_t> droppedFrames = 0;
+
+bool isSocketOpen(WS* ws, uint64_t session) {
+    return currentLoop && currentLoop->sockets.count(ws) && ws->getUserData()->session == session;
+}
+
+
+
+// ─────────────────────────────────────────────
+// WebSocket Loops - one uWS::App per thread, all on the same port
+// ─────────────────────────────────────────────
+
+std::mutex loopsMutex;
+std::vector<std::unique_ptr<WebSocketLoop>> webSocketLoops;
+bool webSocketLoopsStopping = false;
+thread_local WebSocketLoop* currentLoop = nullptr;
 
 
 
@@ -90,52 +116,224 @@ void onOpen(WS* ws) {
     if (!data) return; 
 
     data->id = idAllocator.allocate();
+    data->session = nextSession.fetch_add(1, std::memory_order_relaxed);
     activeConnections.fetch_add(1, std::memory_order_relaxed);
+    currentLoop->connections.fetch_add(1, std::memory_order_relaxed);
+    currentLoop->sockets.insert(ws);
 
     std::cout << color("connect")
               << "Client connected with ID:    [" << data->id << "]\n"
               << color("log")
               << "Active connections:          [" << activeConnections.load()
-              << "]\n\n" << std::flush;
+              << "] (loop " << currentLoop->index << ": " << currentLoop->connections.load() << ")\n\n" << std::flush;
+}
 
-    std::lock_guard<std::mutex> lock(socketMutex);
-    activeSockets.insert(ws);
+static bool isRequestLength(size_t length) {
+    return length == EXPECTED_MESSAGE_LENGTH || length == EXPECTED_MESSAGE_LENGTH + SELECTION_TRAILER_LENGTH ||
+           length == EXPECTED_RANGE_MESSAGE_LENGTH || length == EXPECTED_RANGE_MESSAGE_LENGTH + SELECTION_TRAILER_LENGTH;
+}
+
+static bool handleEncodingMessage(WS* ws, std::string_view message, uWS::OpCode opCode) {
+    if (message.length() != ENCODING_MESSAGE_LENGTH || message[0] != ENCODING_COMMAND) return false;
+
+    uint8_t encoding = static_cast<uint8_t>(message[1]);
+    if (encoding & ~ENCODING_ALL) {
+        char reply[sizeof(double) + 1] = {};
+        reply[sizeof(double)] = static_cast<char>(MessageMode::ERROR);
+        ws->send(std::string_view(reply, sizeof(reply)), opCode);
+        return true;
+    }
+
+    EncodingState& state = ws->getUserData()->encoding;
+    state.encoding = encoding;
+    state.reset();
+    ws->send(message, opCode);                                  // Acknowledged by echoing it
+    return true;
 }
 
 void onMessage(WS* ws, std::string_view message, uWS::OpCode opCode) {
-    if (message.length() != EXPECTED_MESSAGE_LENGTH) {
+    countMetric(MetricsCounter::BYTES_IN, message.size());
+    if (handleEncodingMessage(ws, message, opCode)) return;
+    if (handleSubscriptionMessage(ws, message, opCode)) return;
+
+    if (!isRequestLength(message.length()) && !isMultiRequest(message)) {
         ws->send(message, opCode);
         return;
     }
 
-    std::unique_lock<std::mutex> lock(spiceMutex);
-    spiceCondition.wait(lock, [] { return spiceDataAvailable.load(); });
+    countRequest(message);
+    setCurrentTrace(sampleTrace());
+    traceInstant(TraceStage::REQUEST_BEGIN);
+    uint64_t start = traceStart();
 
-    RequestHandler requestHandler(message);
-    lock.unlock();
+    bool answered = dispatchRequest(ws, std::string(message), opCode);
+    traceStage(TraceStage::ON_MESSAGE, start);
+    if (answered) traceInstant(TraceStage::REQUEST_END);
+    setCurrentTrace(0);
+}
+
+bool dispatchRequest(WS* ws, std::string&& request, uWS::OpCode opCode, uint64_t subscription) {
+    if (isResponseCacheEnabled() && serverOptions.responseCacheSnap) snapRequestTimestamp(request);
+
+    // Subscriptions pace themselves, only client-driven streams are followed
+    bool prefetchable = !subscription && isPrefetchEnabled() && isPrefetchableRequest(request);
+    uint64_t start = traceStart();
+    PrefetchResult prefetched = prefetchable ? takePrefetched(ws, request, opCode) : PrefetchResult::MISS;
+    if (prefetchable) traceStage(TraceStage::PREFETCH, start);
+    if (prefetched != PrefetchResult::MISS) {
+        schedulePrefetch(ws, opCode);                           // Keeps the stream ahead of the client
+        return prefetched == PrefetchResult::SENT;              // A waiting request is sent by completePrefetch
+    }
+
+    if (isResponseCacheEnabled()) {
+        static thread_local std::string response;
+        start = traceStart();
+        bool hit = responseCache.lookup(request, response);
+        traceStage(TraceStage::RESPONSE_CACHE, start);
+        if (hit) {
+            sendResponse(ws, response, requestComponents(request), opCode);
+            return true;
+        }
+    }
+
+    // Snapshot interpolation needs no SPICE: answered on the loop, like a cache hit
+    static thread_local std::string snapshotResponse;
+    start = traceStart();
+    if (answerFromSnapshot(request, snapshotResponse)) {
+        traceStage(TraceStage::SNAPSHOT, start);
+        if (isMultiRequest(request)) sendMultiResponse(ws, snapshotResponse, opCode);
+        else sendResponse(ws, snapshotResponse, requestComponents(request), opCode);
+        return true;
+    }
 
-    ws->send(requestHandler.getMessage(), opCode);
+    // SPICE work happens on the compute thread, the loop only hands the request over
+    start = traceStart();
+    submitComputeTask({
+        ws,
+        ws->getUserData()->session,
+        uWS::Loop::get(),
+        opCode,
+        std::move(request),
+        responseCache.generation(),
+        subscription
+    });
+    traceStage(TraceStage::SUBMIT, start);
+    return false;                                               // Prefetch is scheduled once the response is sent
+}
+
+static bool isRealTimeResponse(std::string_view response) {
+    if (response.size() <= sizeof(double)) return false;
+    MessageMode mode = static_cast<MessageMode>(response[sizeof(double)] & ~MESSAGE_FLAG_TDB);
+    return mode == MessageMode::ALL_INSTANTANEOUS || mode == MessageMode::ALL_LIGHT_TIME_ADJUSTED;
+}
 
-    #ifdef DEBUG
-        printResponse(requestHandler.getMessage());
-    #endif
+static void dropFrame(UserData* data) {
+    data->droppedFrames++;
+    droppedFrames.fetch_add(1, std::memory_order_relaxed);
+}
+
+// Encoding, compression and send of one frame, the tail of every response a client gets
+static void sendFrame(WS* ws, std::string_view response, uint8_t components, uWS::OpCode opCode) {
+    EncodingState& state = ws->getUserData()->encoding;
+    uint64_t traced = traceStart();                             // Encoding, compression and send
+    uint64_t start = stageStart();
+
+    bool large;
+    std::string_view payload = serializeFrame(response, components, state, large);
+    recordStage(MetricsStage::SERIALIZE, start);
+
+    // permessage-deflate, if --deflate and the client agreed
+    start = stageStart();
+    WS::SendStatus status = ws->send(payload, opCode, large);
+    recordStage(MetricsStage::SEND, start);
+    traceStage(TraceStage::SEND, traced);
+    if (status == WS::SendStatus::DROPPED) {
+        dropFrame(ws->getUserData());
+        state.reset();                                          // The client never saw the base of the next delta
+        return;
+    }
+    countMetric(MetricsCounter::BYTES_OUT, payload.size());
+    recordBuffered(ws->getBufferedAmount());
+}
+
+static void writeResponse(WS* ws, std::string_view response, uint8_t components, uWS::OpCode opCode) {
+    countResponse(response);
+    sendFrame(ws, response, components, opCode);
+}
+
+void sendResponse(WS* ws, std::string_view response, uint8_t components, uWS::OpCode opCode) {
+    UserData* data = ws->getUserData();
+    if (!isRealTimeResponse(response)) {                        // Bulk and error frames are queued
+        writeResponse(ws, response, components, opCode);
+        return;
+    }
+
+    // A newer real-time frame makes any waiting one stale
+    if (!data->pendingResponse.empty()) {
+        dropFrame(data);
+        data->pendingResponse.clear();
+    }
+    if (ws->getBufferedAmount() > serverOptions.maxBuffered) {
+        data->pendingResponse.assign(response);
+        data->pendingComponents = components;
+        data->pendingOpCode = opCode;
+        return;
+    }
+    writeResponse(ws, response, components, opCode);
+}
+
+void onDrain(WS* ws) {
+    UserData* data = ws->getUserData();
+    if (data->pendingResponse.empty() || ws->getBufferedAmount() > serverOptions.maxBuffered) return;
+
+    writeResponse(ws, data->pendingResponse, data->pendingComponents, data->pendingOpCode);
+    data->pendingResponse.clear();                              // Keeps its capacity for the next parked frame
+}
+
+// Length-prefixed replies of a multi-request response, in request order
+template <typename Visit>
+static void forEachMultiReply(std::string_view response, Visit visit) {
+    size_t offset = MULTI_REQUEST_HEADER_LENGTH;
+    while (offset + sizeof(uint32_t) <= response.size()) {
+        uint32_t length;
+        std::memcpy(&length, response.data() + offset, sizeof(length));
+        offset += sizeof(length);
+        visit(response.substr(offset, length));
+        offset += length;
+    }
+}
+
+void sendMultiResponse(WS* ws, std::string_view response, uWS::OpCode opCode) {
+    if (static_cast<uint8_t>(response[1]) & MULTI_REQUEST_CONCATENATE) {
+        if (isMetricsEnabled()) forEachMultiReply(response, countResponse);
+        sendFrame(ws, response, COMPONENT_ALL, opCode);         // Not value-encoded, zstd compressed like range frames
+        return;
+    }
+
+    // One frame per request, corked so they leave the server in a single write.
+    // Queued like bulk frames: parking would keep only the last reply under backpressure.
+    ws->cork([ws, response, opCode]() {
+        forEachMultiReply(response, [ws, opCode](std::string_view reply) { writeResponse(ws, reply, COMPONENT_ALL, opCode); });
+    });
 }
 
 void onClose(WS* ws, int code, std::string_view message) {
     UserData* data = ws->getUserData();
     if (!data) return;
 
+    endSubscription(ws);
+    endPrefetch(ws);
     idAllocator.release(data->id);
     activeConnections.fetch_sub(1, std::memory_order_relaxed);
+    currentLoop->connections.fetch_sub(1, std::memory_order_relaxed);
+    currentLoop->sockets.erase(ws);
 
     std::cout << color("disconnect")
               << "Client disconnected with ID: [" << data->id << "]\n"
               << color("log")
-              << "Active connections:          [" << activeConnections.load() << "]\n\n"
-              << std::flush;
-
-    std::lock_guard<std::mutex> lock(socketMutex);
-    activeSockets.erase(ws);
+              << "Dropped frames:              [" << data->droppedFrames << "]\n"
+              << "Active connections:          [" << activeConnections.load()
+              << "] (loop " << currentLoop->index << ": " << currentLoop->connections.load() << ")\n\n" << std::flush;
 }
 
 
@@ -144,19 +342,26 @@ void onClose(WS* ws, int code, std::string_view message) {
 // WebSocket Shutdown Control
 // ─────────────────────────────────────────────
 
-us_listen_socket_t* listenSocket = nullptr;
-
 void stopWebSocketManagerWorker() {
     std::cout << color("log") <<"WebSocketManager shutdown requested.\n"
-              << "Closing " << activeSockets.size() << " connections...\n"
+              << "Closing " << activeConnections.load() << " connections...\n"
               << std::flush;
 
-    std::unique_lock<std::mutex> lock(socketMutex);
-    if(listenSocket) us_listen_socket_close(0, listenSocket);
-    auto socketsCopy = activeSockets;
-    lock.unlock();
-
-    for (auto* ws : socketsCopy) {
-        if (ws) ws->end(1000, "Server shutdown");
+    // Sockets belong to their loop thread: close them there. A loop without
+    // a listen socket and connections returns from run(), ending its thread.
+    std::lock_guard<std::mutex> lock(loopsMutex);
+    webSocketLoopsStopping = true;
+    for (auto& state : webSocketLoops) {
+        if (!state->loop) continue;
+        WebSocketLoop* owner = state.get();
+        state->loop->defer([owner]() {
+            if (owner->listenSocket) us_listen_socket_close(0, owner->listenSocket);
+            owner->listenSocket = nullptr;
+
+            auto socketsCopy = owner->sockets;
+            for (auto* ws : socketsCopy) {
+                if (ws) ws->end(1000, "Server shutdown");
+            }
+        });
     }
 }
@@ -0,0 +1,618 @@
+/*
+ *  Copyright 2025 Mendel Dobondi-Reisz
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+// C++ Standard Libraries
+#include <string_view>
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <cstring>
+#include <cstdint>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include <mutex>
+#include <deque>
+
+// System Libraries
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <signal.h>
+#include <spawn.h>
+#include <fcntl.h>
+#include <unistd.h>
+#ifdef __linux__
+    #include <sys/prctl.h>
+#endif
+
+// Project Headers
+#include <data_manager.hpp>
+#include <worker_pool.hpp>
+#include <state_cache.hpp>
+#include <spice_core.hpp>
+#include <request_trace.hpp>
+#include <metrics.hpp>
+#include <utils.hpp>
+
+extern char** environ;
+
+
+
+// ─────────────────────────────────────────────
+// Worker Process - entry point and helpers
+// ─────────────────────────────────────────────
+
+size_t workerPoolMappingSize(int workerCount, bool traceRings) {
+    size_t slots = 2 * static_cast<size_t>(workerCount);
+    return sizeof(WorkerPoolControl) + slots * sizeof(WorkerSlot) + (traceRings ? slots * sizeof(TraceRing) : 0);
+}
+
+WorkerSlot* workerSlot(WorkerPoolControl* control, int index) {
+    char* base = reinterpret_cast<char*>(control) + sizeof(WorkerPoolControl);
+    return reinterpret_cast<WorkerSlot*>(base + static_cast<size_t>(index) * sizeof(WorkerSlot));
+}
+
+TraceRing* workerTraceRing(WorkerPoolControl* control, int index) {
+    if (!control->traceRings) return nullptr;
+    char* base = reinterpret_cast<char*>(workerSlot(control, 2 * static_cast<int>(control->workerCount)));
+    return reinterpret_cast<TraceRing*>(base + static_cast<size_t>(index) * sizeof(TraceRing));
+}
+
+void pollBackoff(int idleRounds) {
+    if (idleRounds < 64) return;                                        // Busy spin, lowest latency
+    if (idleRounds < 128) std::this_thread::yield();
+    else std::this_thread::sleep_for(std::chrono::microseconds(50));    // Idle, stop burning the core
+}
+
+bool isSpiceWorkerInvocation(int argc, char** argv) {
+    return argc > 1 && std::strcmp(argv[1], SPICE_WORKER_FLAG) == 0;
+}
+
+static bool writeWorkerResponse(WorkerPoolControl* control, WorkerSlot* slot, uint64_t tag, std::string_view response) {
+    size_t offset = 0;
+    int idleRounds = 0;
+
+    do {
+        ResponseSlot* chunk = slot->responses.back();
+        if (!chunk) {                                                   // Server is behind, wait for a free slot
+            if (!control->shouldRun.load(std::memory_order_acquire)) return false;
+            pollBackoff(idleRounds++);
+            continue;
+        }
+        idleRounds = 0;
+
+        size_t length = std::min(response.size() - offset, static_cast<size_t>(WORKER_RESPONSE_CHUNK_SIZE));
+        chunk->tag = tag;
+        chunk->length = static_cast<uint32_t>(length);
+        std::memcpy(chunk->data, response.data() + offset, length);
+        offset += length;
+        chunk->last = offset == response.size();
+        slot->responses.push();
+    } while (offset < response.size());
+
+    return true;
+}
+
+int runSpiceWorker(int argc, char** argv) {
+    if (argc < 4) return ERR_INVALID_ARGUMENTS;
+
+    #ifdef __linux__
+        prctl(PR_SET_PDEATHSIG, SIGTERM);                               // Never outlive the server
+    #endif
+    pid_t parent = getppid();
+
+    int index = std::atoi(argv[3]);
+    loadOptions(argc, argv, serverOptions, 4);                          // Same options as the server
+
+    int fd = shm_open(argv[2], O_RDWR, 0600);
+    if (fd == -1) return ERR_INVALID_ARGUMENTS;
+
+    struct stat info;
+    if (fstat(fd, &info) == -1) { close(fd); return ERR_INVALID_ARGUMENTS; }
+
+    void* mapping = mmap(nullptr, info.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) return ERR_INVALID_ARGUMENTS;
+
+    WorkerPoolControl* control = static_cast<WorkerPoolControl*>(mapping);
+    if (index < 0 || index >= 2 * static_cast<int>(control->workerCount) ||
+        static_cast<size_t>(info.st_size) < workerPoolMappingSize(control->workerCount, control->traceRings)) {
+        munmap(mapping, info.st_size);
+        return ERR_INVALID_ARGUMENTS;
+    }
+
+    WorkerSlot* slot = workerSlot(control, index);
+    slot->pid.store(getpid(), std::memory_order_release);
+    slot->state.store(WorkerState::LOADING, std::memory_order_release);
+    bindThreadMetrics(&slot->metrics);                          // Summed by the server's /metrics
+    if (TraceRing* ring = workerTraceRing(control, index)) {    // Dumped by the server's trace command
+        bindTraceRing(ring, ("worker " + std::to_string(index)).c_str());
+    }
+
+    uint64_t loadedGeneration = 0;
+    int idleRounds = 0;
+    std::string responseBuffer;                                 // Serialized in place, copied once into the ring
+
+    while (control->shouldRun.load(std::memory_order_acquire) && getppid() == parent) {
+        bool available = control->kernelsAvailable.load(std::memory_order_acquire);
+        uint64_t generation = control->kernelGeneration.load(std::memory_order_acquire);
+
+        // Follow the kernel state published by the data manager
+        if (!available || generation != loadedGeneration) {
+            if (loadedGeneration) {
+                slot->state.store(WorkerState::LOADING, std::memory_order_release);
+                deinitSpiceCore();
+                loadedGeneration = 0;
+                slot->loadedGeneration.store(0, std::memory_order_release);
+            }
+            if (!available) { pollBackoff(idleRounds++); continue; }
+
+            initSpiceCore();
+            invalidateStateCache();
+            loadedGeneration = generation;
+            slot->loadedGeneration.store(generation, std::memory_order_release);
+            slot->state.store(WorkerState::READY, std::memory_order_release);
+        }
+
+        RequestSlot* request = slot->requests.front();
+        if (!request) {
+            if (slot->retire.load(std::memory_order_acquire)) break;    // Replaced by a new bank and drained
+            pollBackoff(idleRounds++);
+            continue;
+        }
+        idleRounds = 0;
+
+        uint64_t tag = request->tag;
+        setCurrentTrace(request->trace);
+        traceStage(TraceStage::WORKER_RING, request->submittedAt);
+        std::string_view response = processRequest(std::string_view(request->data, request->length), responseBuffer);
+        setCurrentTrace(0);
+        slot->requests.pop();
+
+        if (!writeWorkerResponse(control, slot, tag, response)) break;
+    }
+
+    if (loadedGeneration) deinitSpiceCore();
+    slot->loadedGeneration.store(0, std::memory_order_release);
+    slot->state.store(WorkerState::EXITED, std::memory_order_release);
+    munmap(mapping, info.st_size);
+    return SUCCESSFUL_EXIT;
+}
+
+
+
+// ─────────────────────────────────────────────
+// Worker Pool - owned by the server process
+// ─────────────────────────────────────────────
+
+WorkerPool::WorkerPool(int workerCount, std::vector<std::string> workerOptions) {
+    this->workerOptions = std::move(workerOptions);
+    this->workerCount = std::max(1, std::min(workerCount, MAX_WORKERS));
+    this->shmName = "/hera_spice_ws_server." + std::to_string(getpid());
+    this->mappedSize = workerPoolMappingSize(this->workerCount, isTracingEnabled());
+    this->control = nullptr;
+    this->inFlight.resize(2 * this->workerCount);
+    this->partial.resize(2 * this->workerCount);
+    this->lastSupervision = std::chrono::steady_clock::now();
+}
+
+WorkerPool::~WorkerPool() {
+    stop();
+}
+
+WorkerSlot* WorkerPool::worker(int index) const {
+    return workerSlot(control, index);
+}
+
+int WorkerPool::activeBank() const {
+    return static_cast<int>(control->activeBank.load(std::memory_order_acquire));
+}
+
+bool WorkerPool::start() {
+    shm_unlink(shmName.c_str());                                        // Leftover from a crashed run with the same pid
+    int fd = shm_open(shmName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd == -1) {
+        std::cerr << color("error") << "Failed to create worker shared memory: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    if (ftruncate(fd, mappedSize) == -1) {
+        std::cerr << color("error") << "Failed to size worker shared memory: " << std::strerror(errno) << std::endl;
+        close(fd);
+        shm_unlink(shmName.c_str());
+        return false;
+    }
+
+    void* mapping = mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        std::cerr << color("error") << "Failed to map worker shared memory: " << std::strerror(errno) << std::endl;
+        shm_unlink(shmName.c_str());
+        return false;
+    }
+
+    // The mapping is zero-filled: every ring is empty and every worker slot is EMPTY
+    control = static_cast<WorkerPoolControl*>(mapping);
+    control->workerCount = workerCount;
+    control->traceRings = isTracingEnabled();
+    control->shouldRun.store(true, std::memory_order_release);
+
+    for (int i = 0; i < workerCount; i++) {
+        if (!spawnWorker(i)) {
+            stop();
+            return false;
+        }
+    }
+
+    std::cout << color("log") << "Started " << workerCount << " SPICE worker processes.\n" << std::flush;
+    return true;
+}
+
+bool WorkerPool::spawnWorker(int index, bool resetRings) {
+    WorkerSlot* slot = worker(index);
+    if (resetRings) {                                                   // Only from the dispatcher thread, which owns the other ends
+        slot->requests.reset();
+        slot->responses.reset();
+    }
+    slot->retire.store(0);
+    slot->loadedGeneration.store(0);
+    slot->state.store(WorkerState::LOADING, std::memory_order_release);
+
+    std::string executable = getExecutablePath().string();
+    std::string indexArgument = std::to_string(index);
+    std::vector<char*> arguments = {
+        const_cast<char*>(executable.c_str()),
+        const_cast<char*>(SPICE_WORKER_FLAG),
+        const_cast<char*>(shmName.c_str()),
+        const_cast<char*>(indexArgument.c_str())
+    };
+    for (const auto& option : workerOptions) arguments.push_back(const_cast<char*>(option.c_str()));
+    arguments.push_back(nullptr);
+
+    pid_t pid;
+    int error = posix_spawn(&pid, executable.c_str(), nullptr, nullptr, arguments.data(), environ);
+    if (error) {
+        std::cerr << color("error") << "Failed to spawn SPICE worker " << index << ": " << std::strerror(error) << std::endl;
+        slot->state.store(WorkerState::EMPTY, std::memory_order_release);
+        return false;
+    }
+
+    slot->pid.store(pid, std::memory_order_release);
+    return true;
+}
+
+void WorkerPool::stop() {
+    if (!control) return;
+
+    control->shouldRun.store(false, std::memory_order_release);
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    for (int i = 0; i < 2 * workerCount; i++) {
+        pid_t pid = worker(i)->pid.load(std::memory_order_acquire);
+        if (pid <= 0) continue;
+
+        while (waitpid(pid, nullptr, WNOHANG) == 0) {
+            if (std::chrono::steady_clock::now() > deadline) {
+                kill(pid, SIGKILL);                                     // Stuck in a long SPICE call
+                waitpid(pid, nullptr, 0);
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
+
+    munmap(control, mappedSize);
+    shm_unlink(shmName.c_str());
+    control = nullptr;
+}
+
+int WorkerPool::size() const {
+    return workerCount;
+}
+
+int WorkerPool::readyWorkers() const {
+    int ready = 0;
+    int first = activeBank() * workerCount;
+    for (int i = first; i < first + workerCount; i++) {
+        if (worker(i)->state.load(std::memory_order_acquire) == WorkerState::READY) ready++;
+    }
+    return ready;
+}
+
+bool WorkerPool::submit(uint64_t tag, std::string_view request, uint64_t trace) {
+    if (request.size() > WORKER_REQUEST_SIZE) return false;
+
+    // Least loaded ready worker of the active bank with a free request slot
+    int target = -1;
+    int first = activeBank() * workerCount;
+    for (int i = first; i < first + workerCount; i++) {
+        if (worker(i)->state.load(std::memory_order_acquire) != WorkerState::READY) continue;
+        if (inFlight[i].size() >= WORKER_RING_CAPACITY) continue;
+        if (target == -1 || inFlight[i].size() < inFlight[target].size()) target = i;
+    }
+    if (target == -1) return false;
+
+    RequestSlot* slot = worker(target)->requests.back();
+    if (!slot) return false;
+
+    slot->tag = tag;
+    slot->trace = trace;
+    slot->submittedAt = trace ? steadyNanoseconds() : 0;
+    slot->length = static_cast<uint32_t>(request.size());
+    std::memcpy(slot->data, request.data(), request.size());
+    worker(target)->requests.push();
+
+    inFlight[target].push_back(tag);
+    return true;
+}
+
+size_t WorkerPool::poll(const std::function<void(uint64_t, std::string&&)>& onResponse) {
+    size_t completed = 0;
+
+    for (int i = 0; i < 2 * workerCount; i++) {                         // A draining bank still answers
+        WorkerSlot* slot = worker(i);
+        while (ResponseSlot* chunk = slot->responses.front()) {
+            partial[i].append(chunk->data, chunk->length);
+            uint64_t tag = chunk->tag;
+            bool last = chunk->last;
+            slot->responses.pop();
+
+            if (!last) continue;
+
+            if (!inFlight[i].empty() && inFlight[i].front() == tag) inFlight[i].pop_front();
+            onResponse(tag, std::move(partial[i]));
+            partial[i].clear();
+            completed++;
+        }
+    }
+
+    return completed;
+}
+
+void WorkerPool::superviseWorkers(std::vector<uint64_t>& lostTags) {
+    auto now = std::chrono::steady_clock::now();
+    if (now - lastSupervision < std::chrono::milliseconds(100)) return;
+    lastSupervision = now;
+
+    int first = activeBank() * workerCount;
+    for (int i = 0; i < 2 * workerCount; i++) {
+        WorkerSlot* slot = worker(i);
+        bool active = i >= first && i < first + workerCount;
+        bool retiring = slot->retire.load(std::memory_order_acquire);
+
+        // A retired worker that exited cleanly saw an empty ring: anything still in flight
+        // was pushed after it looked and will never be answered (responses were polled above)
+        if (retiring && slot->state.load(std::memory_order_acquire) == WorkerState::EXITED) {
+            if (!inFlight[i].empty() && !slot->responses.front()) {
+                lostTags.insert(lostTags.end(), inFlight[i].begin(), inFlight[i].end());
+                inFlight[i].clear();
+                partial[i].clear();
+            }
+            continue;                                                   // Reaped by retireBank
+        }
+
+        pid_t pid = slot->pid.load(std::memory_order_acquire);
+        if (pid <= 0 || waitpid(pid, nullptr, WNOHANG) != pid) continue;
+
+        lostTags.insert(lostTags.end(), inFlight[i].begin(), inFlight[i].end());
+        inFlight[i].clear();
+        partial[i].clear();
+        slot->pid.store(0, std::memory_order_release);
+
+        if (!active) {                                                  // Draining or loading for a swap: not respawned
+            slot->state.store(WorkerState::EXITED, std::memory_order_release);
+            std::cerr << color("warn") << "SPICE worker " << i << " (pid " << pid << ") of the inactive bank exited.\n" << std::flush;
+            continue;
+        }
+
+        std::cerr << color("warn") << "SPICE worker " << i << " (pid " << pid << ") exited, respawning.\n" << std::flush;
+        spawnWorker(i);
+    }
+}
+
+void WorkerPool::forEachWorkerMetrics(const std::function<void(const ThreadMetrics&)>& visit) const {
+    if (!control) return;
+    for (int i = 0; i < 2 * workerCount; i++) visit(worker(i)->metrics);
+}
+
+void WorkerPool::forEachWorkerTrace(const std::function<void(const TraceRing&)>& visit) const {
+    if (!control || !control->traceRings) return;
+    for (int i = 0; i < 2 * workerCount; i++) visit(*workerTraceRing(control, i));
+}
+
+void WorkerPool::publishKernels() {
+    if (!control) return;
+    control->kernelGeneration.fetch_add(1, std::memory_order_acq_rel);
+    control->kernelsAvailable.store(true, std::memory_order_release);
+}
+
+void WorkerPool::withdrawKernels() {
+    if (!control) return;
+    control->kernelsAvailable.store(false, std::memory_order_release);
+
+    // Workers finish the request at hand, then unload
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+    for (int i = 0; i < 2 * workerCount; i++) {
+        while (worker(i)->loadedGeneration.load(std::memory_order_acquire) != 0 &&
+               std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
+}
+
+
+
+bool WorkerPool::swapKernels() {
+    if (!control) return false;
+
+    int oldBank = activeBank();
+    int newBank = 1 - oldBank;
+    int first = newBank * workerCount;
+
+    // Rings of the new bank are empty (drained before its last retirement), the dispatcher keeps them
+    for (int i = first; i < first + workerCount; i++) {
+        if (!spawnWorker(i, false)) {
+            retireBank(newBank);
+            return false;
+        }
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::minutes(2);
+    while (true) {
+        int ready = 0;
+        bool failed = false;
+        for (int i = first; i < first + workerCount; i++) {
+            WorkerState state = worker(i)->state.load(std::memory_order_acquire);
+            if (state == WorkerState::READY) ready++;
+            if (state == WorkerState::EXITED || worker(i)->pid.load(std::memory_order_acquire) <= 0) failed = true;
+        }
+        if (ready == workerCount) break;
+
+        if (failed || std::chrono::steady_clock::now() > deadline) {
+            std::cerr << color("error") << "New SPICE workers failed to load the kernels, keeping the current ones.\n" << std::flush;
+            retireBank(newBank);
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    control->activeBank.store(newBank, std::memory_order_release);     // Atomic switch for the dispatcher
+    std::cout << color("log") << "Switched to " << workerCount << " SPICE workers with the new kernels.\n" << std::flush;
+
+    retireBank(oldBank);
+    return true;
+}
+
+void WorkerPool::retireBank(int bank) {
+    int first = bank * workerCount;
+    for (int i = first; i < first + workerCount; i++) worker(i)->retire.store(1, std::memory_order_release);
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+    for (int i = first; i < first + workerCount; i++) {
+        WorkerSlot* slot = worker(i);
+        pid_t pid = slot->pid.load(std::memory_order_acquire);
+        if (pid <= 0) continue;
+
+        while (slot->state.load(std::memory_order_acquire) != WorkerState::EXITED &&
+               slot->pid.load(std::memory_order_acquire) > 0 && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+
+        if (slot->state.load(std::memory_order_acquire) != WorkerState::EXITED && slot->pid.load() > 0) {
+            kill(pid, SIGKILL);                                         // Stuck: the dispatcher resubmits its requests
+            auto grace = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+            while (slot->pid.load(std::memory_order_acquire) > 0 && std::chrono::steady_clock::now() < grace) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+        }
+
+        if (slot->pid.load(std::memory_order_acquire) > 0) waitpid(pid, nullptr, 0);
+        slot->pid.store(0, std::memory_order_release);
+        slot->state.store(WorkerState::EXITED, std::memory_order_release);
+    }
+}
+
+
+
+// ─────────────────────────────────────────────
+// Worker Pool Instance - nullptr when SPICE runs in-process
+// ─────────────────────────────────────────────
+
+WorkerPool* workerPool = nullptr;
+
+bool startWorkerPool(int workerCount, std::vector<std::string> workerOptions) {
+    workerPool = new WorkerPool(workerCount, std::move(workerOptions));
+    if (workerPool->start()) return true;
+
+    delete workerPool;
+    workerPool = nullptr;
+    return false;
+}
+
+void stopWorkerPool() {
+    if (!workerPool) return;
+    delete workerPool;
+    workerPool = nullptr;
+}
+
+
+
+// ─────────────────────────────────────────────
+// Swap Worker - answers for the compute thread while it reloads, without --workers
+// ─────────────────────────────────────────────
+
+std::vector<std::string> workerProcessOptions;
+
+static WorkerPool* swapWorker = nullptr;
+static std::mutex swapWorkerMutex;                                      // Held by the compute thread while it waits for an answer
+static std::atomic<bool> swapWorkerStopping = false;
+
+bool startSwapWorker() {
+    WorkerPool* pool = new WorkerPool(1, workerProcessOptions);
+    if (!pool->start()) {
+        delete pool;
+        return false;
+    }
+    pool->publishKernels();
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::minutes(2);
+    while (pool->readyWorkers() < 1) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            delete pool;
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    std::lock_guard<std::mutex> lock(swapWorkerMutex);
+    swapWorkerStopping = false;
+    swapWorker = pool;
+    return true;
+}
+
+bool answerOnSwapWorker(std::string_view request, uint64_t trace, std::string& response) {
+    static uint64_t nextTag = 1;
+    std::lock_guard<std::mutex> lock(swapWorkerMutex);
+    if (!swapWorker) return false;
+
+    uint64_t tag = nextTag++;
+    if (!swapWorker->submit(tag, request, trace)) return false;
+
+    bool answered = false;
+    std::vector<uint64_t> lostTags;
+    int idleRounds = 0;
+    while (!answered) {
+        if (swapWorker->poll([&](uint64_t id, std::string&& answer) {
+                if (id == tag) { response = std::move(answer); answered = true; } })) {
+            idleRounds = 0;
+            continue;
+        }
+        swapWorker->superviseWorkers(lostTags);
+        if (!lostTags.empty() || swapWorkerStopping.load()) return false;     // The compute thread waits for its own kernels
+        pollBackoff(idleRounds++);
+    }
+    return true;
+}
+
+void stopSwapWorker() {
+    swapWorkerStopping = true;
+    std::lock_guard<std::mutex> lock(swapWorkerMutex);                  // After the answer the compute thread waits for
+    delete swapWorker;
+    swapWorker = nullptr;
+}